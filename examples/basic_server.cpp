@@ -201,7 +201,11 @@ int main()
             {"total_io_suspended", stats.total_io_suspended},
             {"total_resumed", stats.total_resumed},
             {"work_stolen", stats.work_stolen},
-            {"context_switches", stats.context_switches}
+            {"context_switches", stats.context_switches},
+            {"steal_attempts", stats.steal_attempts},
+            {"steal_success_rate", stats.steal_success_rate},
+            {"avg_run_queue_wait_ns", stats.avg_run_queue_wait_ns},
+            {"avg_mounted_ns", stats.avg_mounted_ns}
         };
         
         Json per_core = Json::array();
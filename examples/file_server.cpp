@@ -106,24 +106,10 @@ int main() {
             return;
         }
 
-        try {
-            if (utils::file_exists(filepath)) {
-                // Get file size for Content-Length header
-                size_t file_size = utils::file_size(filepath);
-                res.header("Content-Length", std::to_string(file_size));
-                
-                // Add caching headers
-                res.header("Cache-Control", "public, max-age=3600");
-                res.header("ETag", "\"" + std::to_string(file_size) + "\"");
-                
-                // Serve the file
-                res.file(filepath);
-            } else {
-                res.not_found("File not found: " + filename);
-            }
-        } catch (const std::exception& e) {
-            res.internal_error("Error reading file: " + std::string(e.what()));
-        }
+        // file() sets Content-Length, a strong ETag and Last-Modified, and
+        // answers revalidations with 304 Not Modified
+        res.header("Cache-Control", "public, max-age=3600");
+        res.file(filepath);
     });
 
     // File upload endpoint
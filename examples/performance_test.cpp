@@ -25,8 +25,9 @@ vthread simulated_io_task(int task_id)
         (void)x;
     }
     
-    // Simulate I/O operation that will cause unmounting
-    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    // Simulate I/O operation that will cause unmounting; the core runs
+    // other virtual threads until the timer wheel resumes this one
+    co_await sleep_for(std::chrono::milliseconds(1));
     
     std::cout << "Virtual thread " << task_id << " I/O completed (remounted on CPU core)" << std::endl;
     
@@ -51,7 +52,7 @@ vthread work_stealing_test()
         vthread_scheduler::instance().schedule(std::move(task));
         
         // Small delay to show work distribution
-        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        co_await sleep_for(std::chrono::milliseconds(1));
     }
     
     co_return;
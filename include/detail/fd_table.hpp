@@ -0,0 +1,86 @@
+#ifndef fd_table_hpp
+#define fd_table_hpp
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace swiftnet::detail
+{
+
+    /* Per-descriptor reactor state.
+     * Each direction has one waiter slot holding either 0 (idle), `ready`
+     * (an edge arrived while nobody was waiting) or the address of the
+     * parked io_awaitable. `owner` is the core whose event_loop has the
+     * descriptor registered, or -1.
+     */
+    struct fd_state
+    {
+        static constexpr std::uintptr_t ready = 1;
+
+        std::atomic<std::uintptr_t> reader{0};
+        std::atomic<std::uintptr_t> writer{0};
+        std::atomic<int> owner{-1};
+    };
+
+    /* Lock-free table of fd_state indexed by descriptor number.
+     * Storage is allocated in fixed chunks on first use and never moves,
+     * so lookups are two loads and entries can be referenced without locks.
+     */
+    class fd_table
+    {
+        static constexpr std::size_t chunk_bits = 10;
+        static constexpr std::size_t chunk_size = std::size_t{1} << chunk_bits;
+        static constexpr std::size_t max_chunks = 1024; // 1M descriptors
+
+        std::array<std::atomic<fd_state *>, max_chunks> chunks_{};
+
+    public:
+        fd_table() = default;
+        fd_table(const fd_table &) = delete;
+        fd_table &operator=(const fd_table &) = delete;
+
+        ~fd_table()
+        {
+            for (auto &c : chunks_)
+                delete[] c.load(std::memory_order_relaxed);
+        }
+
+        // Returns the entry for fd, allocating its chunk if needed.
+        fd_state *get(int fd)
+        {
+            if (fd < 0)
+                return nullptr;
+            std::size_t idx = static_cast<std::size_t>(fd) >> chunk_bits;
+            if (idx >= max_chunks)
+                return nullptr;
+
+            fd_state *chunk = chunks_[idx].load(std::memory_order_acquire);
+            if (!chunk)
+            {
+                auto *fresh = new fd_state[chunk_size];
+                if (chunks_[idx].compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel))
+                    chunk = fresh;
+                else
+                    delete[] fresh;
+            }
+            return &chunk[static_cast<std::size_t>(fd) & (chunk_size - 1)];
+        }
+
+        // Returns the entry for fd if its chunk exists, never allocates.
+        fd_state *find(int fd) const noexcept
+        {
+            if (fd < 0)
+                return nullptr;
+            std::size_t idx = static_cast<std::size_t>(fd) >> chunk_bits;
+            if (idx >= max_chunks)
+                return nullptr;
+            fd_state *chunk = chunks_[idx].load(std::memory_order_acquire);
+            return chunk ? &chunk[static_cast<std::size_t>(fd) & (chunk_size - 1)] : nullptr;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef frame_pool_hpp
+#define frame_pool_hpp
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace swiftnet::detail
+{
+
+    /* Allocator behind every vthread coroutine frame.
+     * Worker threads bind to a per-core cache holding free lists for size
+     * classes of 64 B - 4 KiB, refilled from that core's arena. A frame
+     * freed on its own core goes straight back to the local list; a frame
+     * freed anywhere else is pushed onto the owning core's lock-free
+     * remote list, which the owner reclaims in one exchange when its local
+     * list runs dry. Frames created outside a worker, or larger than the
+     * biggest class, fall back to the global heap.
+     *
+     * Caches and arenas live for the whole process, so frames can safely
+     * outlive a scheduler stop()/start() cycle.
+     */
+    class frame_pool
+    {
+    public:
+        static constexpr std::size_t max_cores = 256;
+
+        static void *allocate(std::size_t size);
+        static void deallocate(void *p) noexcept;
+
+        // Routes allocations made on the calling thread to core's cache
+        static void bind_thread(std::size_t core);
+        static void unbind_thread() noexcept;
+
+        // The core's arena; only to be used from that core's worker thread
+        static std::pmr::memory_resource *arena(std::size_t core);
+    };
+
+}
+
+#endif
@@ -16,6 +16,13 @@
     #include <ws2tcpip.h>
     #include <mswsock.h>
     
+    // Gather-write buffer as on POSIX; tcp_socket sends the pieces in turn
+    struct iovec
+    {
+        void *iov_base;
+        size_t iov_len;
+    };
+    
 #elif defined(__APPLE__) && defined(__MACH__)
     #ifndef SWIFTNET_BACKEND_KQUEUE
         #define SWIFTNET_BACKEND_KQUEUE 1
@@ -26,6 +33,7 @@
     #include <sys/event.h>
     #include <sys/time.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
     #include <unistd.h>
@@ -40,6 +48,7 @@
     // Linux-specific includes
     #include <sys/epoll.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
     #include <unistd.h>
@@ -59,6 +68,7 @@
     
     #include <sys/epoll.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
     #include <unistd.h>
@@ -0,0 +1,81 @@
+#ifndef spsc_ring_hpp
+#define spsc_ring_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace swiftnet::detail
+{
+
+    /* Bounded single-producer / single-consumer ring of trivially
+     * copyable values.
+     * Producer: push(), wait-free; fails when full rather than block.
+     * Consumer: pop(), any number at once.
+     * Each side keeps a stale copy of the other's index and reloads it
+     * only when the ring looks full (or empty), so in steady state a push
+     * touches no cache line the consumer writes.
+     */
+    template <typename T>
+    class spsc_ring
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "spsc_ring slots are copied with plain stores");
+
+        std::size_t mask_;
+        std::unique_ptr<T[]> slots_;
+
+        alignas(64) std::atomic<std::size_t> head_{0}; // next slot to write
+        std::size_t tail_cache_{0};                    // producer's view of tail_
+        alignas(64) std::atomic<std::size_t> tail_{0}; // next slot to read
+        std::size_t head_cache_{0};                    // consumer's view of head_
+
+    public:
+        // Capacity is rounded up to a power of two
+        explicit spsc_ring(std::size_t capacity)
+        {
+            std::size_t cap = 1;
+            while (cap < capacity)
+                cap <<= 1;
+            mask_ = cap - 1;
+            slots_.reset(new T[cap]);
+        }
+
+        spsc_ring(const spsc_ring &) = delete;
+        spsc_ring &operator=(const spsc_ring &) = delete;
+
+        std::size_t capacity() const noexcept { return mask_ + 1; }
+
+        bool push(const T &v) noexcept
+        {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_cache_ > mask_)
+            {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head - tail_cache_ > mask_)
+                    return false;
+            }
+            slots_[head & mask_] = v;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Moves up to max values into out; returns how many
+        std::size_t pop(T *out, std::size_t max) noexcept
+        {
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (head_cache_ - tail < max)
+                head_cache_ = head_.load(std::memory_order_acquire);
+            std::size_t n = head_cache_ - tail;
+            if (n > max)
+                n = max;
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = slots_[(tail + i) & mask_];
+            tail_.store(tail + n, std::memory_order_release);
+            return n;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef timer_wheel_hpp
+#define timer_wheel_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace swiftnet::detail
+{
+
+    class timer_wheel;
+
+    /* Intrusive timer entry, embedded in whatever waits on it (an awaitable
+     * in a coroutine frame), so arming never allocates. fire runs on the
+     * wheel's worker once the deadline has passed.
+     */
+    struct timer_node
+    {
+        timer_node *prev{nullptr};
+        timer_node *next{nullptr};
+        std::uint64_t expires{0}; // wheel tick (milliseconds)
+        timer_wheel *wheel{nullptr};
+        void (*fire)(timer_node *){nullptr};
+        void *ctx{nullptr};
+
+        bool armed() const noexcept { return next != nullptr; }
+    };
+
+    /* Hierarchical timing wheel (Varghese & Lauck) with 1 ms ticks.
+     * Four levels of 64 slots cover ~4.6 hours; later deadlines park in
+     * the last level and are re-filed as it cascades. Arming and cancelling
+     * are O(1); advance() costs one slot per elapsed tick plus an
+     * occasional cascade of a higher-level slot.
+     *
+     * Each scheduler core owns one wheel and is the only thread that
+     * advances it. cancel() may come from any core (the reactor that won a
+     * race against a deadline), so the slots sit behind a mutex that is
+     * also held while callbacks run: once cancel() returns the wheel no
+     * longer touches the node. Callbacks must therefore not arm or cancel
+     * timers on the same wheel.
+     */
+    class timer_wheel
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t levels = 4;
+        static constexpr std::size_t slot_bits = 6;
+        static constexpr std::size_t slots = std::size_t{1} << slot_bits;
+
+        timer_wheel();
+        timer_wheel(const timer_wheel &) = delete;
+        timer_wheel &operator=(const timer_wheel &) = delete;
+
+        // Milliseconds on the steady clock. Deadlines round up to the next
+        // tick and the current time rounds down, so nothing fires early.
+        static std::uint64_t to_tick(clock::time_point tp) noexcept;
+        static std::uint64_t now_tick() noexcept;
+
+        void arm(timer_node *n, std::uint64_t expires);
+        // False if the node already fired or was never armed
+        bool cancel(timer_node *n);
+
+        // Fires everything due at or before now
+        void advance(std::uint64_t now);
+
+        // Milliseconds until the next level-0 slot with timers, at most cap
+        int next_timeout_ms(int cap);
+
+    private:
+        std::mutex mutex_;
+        timer_node heads_[levels][slots]; // list sentinels
+        std::uint64_t current_;           // next tick to process
+        std::size_t count_{0};
+
+        void link(timer_node *n);
+        static void unlink(timer_node *n) noexcept;
+        std::size_t cascade(std::size_t level);
+    };
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef ws_deque_hpp
+#define ws_deque_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace swiftnet::detail
+{
+
+    /* Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli 2013).
+     * Owner:  push() / pop() at the bottom, LIFO, no atomic RMW unless it
+     *         races a thief for the last element.
+     * Thieves: steal() from the top, FIFO, one CAS per element.
+     * The ring grows by doubling; retired rings are kept until destruction
+     * because a thief may still be reading from one.
+     */
+    template <typename T>
+    class ws_deque
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "ws_deque slots are copied racily");
+
+        struct ring
+        {
+            std::int64_t mask;
+            std::unique_ptr<std::atomic<T>[]> slots;
+
+            explicit ring(std::int64_t capacity)
+                : mask(capacity - 1), slots(new std::atomic<T>[static_cast<std::size_t>(capacity)]) {}
+
+            std::int64_t capacity() const noexcept { return mask + 1; }
+            T get(std::int64_t i) const noexcept { return slots[i & mask].load(std::memory_order_relaxed); }
+            void put(std::int64_t i, T v) noexcept { slots[i & mask].store(v, std::memory_order_relaxed); }
+        };
+
+        alignas(64) std::atomic<std::int64_t> top_{0};
+        alignas(64) std::atomic<std::int64_t> bottom_{0};
+        alignas(64) std::atomic<ring *> ring_;
+        std::vector<std::unique_ptr<ring>> rings_; // owner-only; back() is current
+
+        ring *grow(ring *old, std::int64_t b, std::int64_t t)
+        {
+            auto fresh = std::make_unique<ring>(old->capacity() * 2);
+            for (std::int64_t i = t; i < b; ++i)
+                fresh->put(i, old->get(i));
+            ring *r = fresh.get();
+            rings_.push_back(std::move(fresh));
+            ring_.store(r, std::memory_order_release);
+            return r;
+        }
+
+    public:
+        explicit ws_deque(std::size_t capacity = 256)
+        {
+            std::int64_t cap = 1;
+            while (cap < static_cast<std::int64_t>(capacity))
+                cap <<= 1;
+            rings_.push_back(std::make_unique<ring>(cap));
+            ring_.store(rings_.back().get(), std::memory_order_relaxed);
+        }
+
+        ws_deque(const ws_deque &) = delete;
+        ws_deque &operator=(const ws_deque &) = delete;
+
+        // Owner only
+        void push(T v)
+        {
+            std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            std::int64_t t = top_.load(std::memory_order_acquire);
+            ring *a = ring_.load(std::memory_order_relaxed);
+            if (b - t > a->capacity() - 1)
+                a = grow(a, b, t);
+            a->put(b, v);
+            // Release store rather than a fence + relaxed store: same code on
+            // x86, and thread sanitizers can see the hand-off
+            bottom_.store(b + 1, std::memory_order_release);
+        }
+
+        // Owner only
+        bool pop(T &out) noexcept
+        {
+            std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            ring *a = ring_.load(std::memory_order_relaxed);
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = top_.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                // Empty
+                bottom_.store(b + 1, std::memory_order_release);
+                return false;
+            }
+
+            out = a->get(b);
+            if (t == b)
+            {
+                // Last element: race thieves for it
+                bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom_.store(b + 1, std::memory_order_release);
+                return won;
+            }
+            return true;
+        }
+
+        // Any thread. Fails if empty or if another thread took the element first.
+        bool steal(T &out) noexcept
+        {
+            std::int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t b = bottom_.load(std::memory_order_acquire);
+            if (t >= b)
+                return false;
+
+            ring *a = ring_.load(std::memory_order_acquire);
+            T v = a->get(t);
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return false;
+            out = v;
+            return true;
+        }
+
+        // Approximate when read from a thread other than the owner
+        std::size_t size() const noexcept
+        {
+            std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            std::int64_t t = top_.load(std::memory_order_relaxed);
+            return b > t ? static_cast<std::size_t>(b - t) : 0;
+        }
+
+        bool empty() const noexcept { return size() == 0; }
+    };
+
+}
+
+#endif
@@ -9,29 +9,43 @@ namespace swiftnet
     {
         int fd;
         std::uint32_t mask; // combination of event_mask values
-        int res = 0;        // result code for io_uring/IOCP
+        int res = 0;        // result code for IOCP
     };
 
     enum event_mask : std::uint32_t
     {
         READABLE = 1u << 0,
-        WRITABLE = 1u << 1
+        WRITABLE = 1u << 1,
+        CLOSED = 1u << 2 // peer hung up or the descriptor is in error
     };
 
+    /* Readiness reactor owned by a single scheduler core.
+     * Descriptors are registered edge-triggered once and stay registered
+     * until del(); wait() is only ever called by the owning worker, while
+     * add/del/notify may be called from any thread.
+     */
     class event_loop
     {
     public:
         event_loop();
         ~event_loop();
 
-        void add(int fd, std::uint32_t mask);
+        event_loop(const event_loop &) = delete;
+        event_loop &operator=(const event_loop &) = delete;
+
+        // Returns false if the descriptor cannot be watched (e.g. a regular file).
+        bool add(int fd, std::uint32_t mask);
         void mod(int fd, std::uint32_t mask);
         void del(int fd);
         int wait(io_event *ev, int max, int timeout_ms);
 
+        // Interrupts a concurrent wait() from another thread.
+        void notify();
+
     private:
-#if defined(SWIFTNET_BACKEND_IOURING)
-        struct io_uring *ring_;
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+        int epfd_;
+        int wakefd_;
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
         int kq_;
 #elif defined(SWIFTNET_BACKEND_IOCP)
@@ -0,0 +1,143 @@
+#ifndef http_access_log_hpp
+#define http_access_log_hpp
+
+#include "detail/spsc_ring.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace swiftnet::http
+{
+
+    /* One request in the binary access log. Fixed-size and written as is,
+     * in host byte order, so a worker's part of logging a request is a
+     * 32-byte copy into its core's ring.
+     */
+    struct access_record
+    {
+        std::uint64_t time_ns;    // completion, nanoseconds since the Unix epoch
+        std::uint64_t latency_ns; // producing the response
+        std::uint64_t bytes;      // response body
+        std::uint16_t status;
+        std::uint16_t route;      // index into the file's route table, or no_route
+        std::uint8_t method;      // access_method
+        std::uint8_t core;        // scheduler core, or no_core
+        std::uint8_t flags;       // access_flag bits
+        std::uint8_t reserved;
+    };
+    static_assert(sizeof(access_record) == 32, "access_record is part of the file format");
+    static_assert(std::is_trivially_copyable_v<access_record>);
+
+    enum class access_method : std::uint8_t
+    {
+        other,
+        get,
+        head,
+        post,
+        put,
+        del,
+        patch,
+        options,
+        connect,
+        trace
+    };
+
+    enum access_flag : std::uint8_t
+    {
+        access_cached = 1 // replayed from the response cache
+    };
+
+    constexpr std::uint16_t no_route = 0xffff;
+    constexpr std::uint8_t no_core = 0xff;
+
+    access_method method_code(std::string_view method) noexcept;
+    std::string_view method_name(access_method m) noexcept;
+
+    /* Each file starts with this header, then the route table (per route
+     * a uint16 length and that many bytes of pattern), then records until
+     * the end of the file.
+     */
+    constexpr char access_log_magic[8] = {'S', 'N', 'A', 'C', 'C', 'L', 'O', 'G'};
+    constexpr std::uint32_t access_log_version = 1;
+
+    struct access_log_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t record_size;
+        std::uint32_t routes;
+        std::uint32_t reserved;
+    };
+    static_assert(sizeof(access_log_header) == 24, "access_log_header is part of the file format");
+
+    /* Per-core rings of access_records, drained by a background thread
+     * into a file that is rotated once it reaches max_file_bytes: path
+     * becomes path.1, path.1 becomes path.2 and so on, keeping max_files
+     * in all. A full ring drops the record (the flusher logs how many)
+     * rather than stall a core. Records from threads other than the
+     * scheduler's workers share one extra ring under a mutex.
+     */
+    class access_log
+    {
+    public:
+        struct options
+        {
+            std::string path;
+            std::size_t max_file_bytes{64 * 1024 * 1024};
+            std::size_t max_files{8};
+            std::size_t ring_records{8192}; // per core
+            std::chrono::milliseconds flush_interval{20};
+        };
+
+        // routes name the route ids records carry. Throws std::runtime_error
+        // if the file cannot be opened.
+        access_log(options opts, std::vector<std::string> routes, std::size_t cores);
+        // Writes out everything recorded so far
+        ~access_log();
+
+        access_log(const access_log &) = delete;
+        access_log &operator=(const access_log &) = delete;
+
+        void record(const access_record &r) noexcept;
+
+        std::uint64_t dropped() const noexcept { return dropped_total_.load(std::memory_order_relaxed); }
+
+    private:
+        using ring = detail::spsc_ring<access_record>;
+
+        options opts_;
+        std::vector<std::string> routes_;
+        std::vector<std::unique_ptr<ring>> rings_; // one per core, then the shared one
+        std::mutex shared_mutex_;                  // producers on the shared ring
+        std::atomic<std::uint64_t> dropped_total_{0};
+
+        // Flusher state
+        std::FILE *file_{nullptr};
+        std::uint64_t file_bytes_{0};
+        std::uint64_t header_bytes_{0}; // the header and route table
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_{false};
+        std::uint64_t dropped_reported_{0};
+        std::thread flusher_;
+
+        void run();
+        void drain();
+        void write(const access_record *records, std::size_t n);
+        bool open_file();
+        void rotate();
+    };
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef http_compression_hpp
+#define http_compression_hpp
+
+#include <string>
+#include <string_view>
+
+namespace swiftnet::http
+{
+
+    /* Content codings for response bodies (RFC 9110 section 8.4.1).
+     * gzip, br and zstd are each available when the library was built
+     * with zlib, brotli or zstd respectively; supported_codings() says
+     * which. Encoders are kept per thread, and so per core for workers,
+     * and reused from one response to the next.
+     */
+    enum class content_coding : unsigned char
+    {
+        identity,
+        gzip,
+        br,
+        zstd
+    };
+
+    constexpr unsigned coding_bit(content_coding c) noexcept
+    {
+        return 1u << static_cast<unsigned>(c);
+    }
+
+    // Token for Content-Encoding; empty for identity
+    std::string_view coding_name(content_coding c) noexcept;
+
+    // coding_bit()s of the codings compress() can produce in this build
+    unsigned supported_codings() noexcept;
+
+    /* Picks the coding to answer an Accept-Encoding field with, among the
+     * coding_bit()s in offered. The highest q-value wins, ties going to
+     * br, then zstd, then gzip; "*" stands for any coding not listed.
+     * identity when the field is empty or accepts none of them.
+     */
+    content_coding negotiate_coding(std::string_view accept_encoding, unsigned offered) noexcept;
+
+    // Whether a body of this Content-Type is worth compressing: text,
+    // JSON, JavaScript, XML and SVG are; images, audio, video and
+    // archives, already compressed, are not
+    bool compressible_type(std::string_view content_type) noexcept;
+
+    // Replaces out with in compressed as c, using this thread's encoder.
+    // false if c is not supported or the encoder failed.
+    bool compress(content_coding c, std::string_view in, std::string &out);
+
+}
+
+#endif
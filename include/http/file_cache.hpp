@@ -0,0 +1,94 @@
+#ifndef http_file_cache_hpp
+#define http_file_cache_hpp
+
+#include "compression.hpp"
+#include "open_file.hpp"
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace swiftnet::http
+{
+
+    // An open file plus the response metadata derived from it once
+    struct cached_file
+    {
+        std::shared_ptr<const open_file> file;
+        std::string mime_type;
+        std::string etag; // strong: device, inode, size and mtime
+        std::time_t mtime{0};       // whole seconds, as Last-Modified carries it
+        std::string last_modified; // mtime as an HTTP-date
+        content_coding coding{content_coding::identity};
+
+        // Precompressed siblings (path.br, path.gz) at least as new as the
+        // file itself, each carrying its own validators but this mime_type
+        std::vector<std::shared_ptr<const cached_file>> encoded;
+
+        // nullptr if path cannot be opened or is not a regular file.
+        // Siblings are only looked for when precompressed is set.
+        static std::shared_ptr<const cached_file> load(const std::string &path,
+                                                       const std::function<std::string(const std::string &)> &mime_of,
+                                                       bool precompressed = false);
+    };
+
+    /* Bounded cache of open files keyed by resolved path.
+     * Keys hash onto independently locked shards, each evicting its least
+     * recently used entry when full, so workers rarely contend. A hit
+     * younger than the revalidation TTL costs no syscall at all. An older
+     * one is checked with a single stat(): if device, inode, size and mtime
+     * still match, the descriptor is kept, otherwise the file is reopened.
+     * Precompressed siblings are found when a file is (re)loaded, so
+     * regenerating them along with the file is what refreshes them.
+     * Evicted descriptors close once the last response sending them ends.
+     */
+    class file_cache
+    {
+    public:
+        using mime_resolver = std::function<std::string(const std::string &path)>;
+
+        static constexpr std::size_t shard_count = 16;
+
+        explicit file_cache(mime_resolver mime_of, std::size_t max_entries = 4096,
+                            std::chrono::milliseconds ttl = std::chrono::seconds(2));
+
+        file_cache(const file_cache &) = delete;
+        file_cache &operator=(const file_cache &) = delete;
+
+        // nullptr if path is not a readable regular file (misses are not cached)
+        std::shared_ptr<const cached_file> get(const std::string &path);
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct entry
+        {
+            std::string path;
+            std::shared_ptr<const cached_file> file;
+            clock::time_point checked;
+        };
+
+        struct shard
+        {
+            std::mutex mutex;
+            std::list<entry> lru; // most recently used first
+            std::unordered_map<std::string, std::list<entry>::iterator> index;
+        };
+
+        mime_resolver mime_of_;
+        std::size_t shard_capacity_;
+        clock::duration ttl_;
+        std::array<shard, shard_count> shards_;
+
+        void store(shard &s, const std::string &path, std::shared_ptr<const cached_file> file, clock::time_point now);
+    };
+
+}
+
+#endif
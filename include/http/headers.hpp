@@ -0,0 +1,89 @@
+#ifndef http_headers_hpp
+#define http_headers_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace swiftnet::http
+{
+
+    /* Preformatted pieces of a response head, so writing one is a handful
+     * of appends instead of number and date formatting per response.
+     */
+
+    // "HTTP/1.1 404 Not Found\r\n" from a table built once; empty outside
+    // 100-599. Codes without a registered reason phrase get an empty one.
+    std::string_view status_line(int status) noexcept;
+
+    // Registered reason phrase, empty if there is none
+    std::string_view reason_phrase(int status) noexcept;
+
+    // "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n" for the current second.
+    // Cached per thread, and so per core for workers, and reformatted only
+    // when the second changes.
+    std::string_view date_field() noexcept;
+
+    constexpr std::string_view server_field = "Server: SwiftNet\r\n";
+
+    // IMF-fixdate, e.g. for Last-Modified: "Sun, 06 Nov 1994 08:49:37 GMT"
+    std::string http_date(std::time_t t);
+
+    // Parses an IMF-fixdate; false for anything else, including the
+    // obsolete RFC 850 and asctime forms
+    bool parse_http_date(std::string_view s, std::time_t &t) noexcept;
+
+    struct byte_range
+    {
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    enum class range_result
+    {
+        ignore,       // no usable Range: send the whole representation
+        satisfiable,  // ranges filled in, clamped to the size
+        unsatisfiable // 416
+    };
+
+    // More ranges than this in one request are not worth serving piecemeal
+    constexpr std::size_t max_ranges = 16;
+
+    /* Parses a Range field (RFC 9110 section 14.2) against a representation
+     * of size bytes. A syntax error (such as no range-spec at all), a unit
+     * other than bytes or more than max_ranges ranges give ignore, as the
+     * RFC allows; ranges that all start past the end give unsatisfiable.
+     */
+    range_result parse_range(std::string_view value, std::uint64_t size, std::vector<byte_range> &out);
+
+    // If-Range (RFC 9110 section 13.1.5): true when Range may be honoured
+    bool if_range_matches(std::string_view if_range, std::string_view etag, std::time_t last_modified) noexcept;
+
+    /* Conditional GET/HEAD (RFC 9110 section 13.2.2): true when the
+     * client's copy is current and a 304 can stand in for the body. An
+     * If-None-Match list (compared weakly, "*" matching anything) takes
+     * precedence; If-Modified-Since is only consulted without one.
+     * Pass empty views for absent fields.
+     */
+    bool not_modified(std::string_view if_none_match, std::string_view if_modified_since,
+                      std::string_view etag, std::time_t last_modified) noexcept;
+
+    // Field name comparison: ASCII case fold, exact for token characters
+    inline bool iequals(std::string_view a, std::string_view b) noexcept
+    {
+        if (a.size() != b.size())
+            return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if ((a[i] | 0x20) != (b[i] | 0x20))
+                return false;
+        }
+        return true;
+    }
+
+}
+
+#endif
@@ -3,35 +3,116 @@
 
 #include "../net/acceptor.hpp"
 #include "../net/tcp_socket.hpp"
+#include "headers.hpp"
+#include "open_file.hpp"
+#include "parser.hpp"
 #include "../vthread_scheduler.hpp"
 #include "../vthread.hpp"
 #include <functional>
 #include <map>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <utility>
+#include <vector>
 #include <atomic>
+#include <chrono>
 
 namespace swiftnet::http
 {
 
+    /* A parsed request. Every field views the connection's read buffer and
+     * is only valid until the handler returns.
+     */
     struct request
     {
-        std::string method;
-        std::string path;
-        std::map<std::string, std::string> headers;
+        std::string_view method;
+        std::string_view path; // request-target as sent, query included
+        std::string_view version;
+        int minor_version{1};
+        std::span<const header_field> headers;
+        std::string_view body;
+
+        // Case-insensitive; empty if the field is absent
+        std::string_view header(std::string_view name) const noexcept;
+
+        // HTTP/1.1 is persistent unless the client sends "close"; 1.0 only
+        // with an explicit keep-alive
+        bool keep_alive() const noexcept;
+
+        // The client waits for "100 Continue" before sending the body
+        bool expects_continue() const noexcept;
+    };
+
+    /* A response serialized once to be sent many times: the status line
+     * and every field but Connection and Date, then the body. Those two
+     * are written per send, so a replayed response is never stale.
+     */
+    struct serialized_response
+    {
+        std::string head; // without the blank line
         std::string body;
     };
 
     struct response
     {
         int status{200};
-        std::map<std::string, std::string> headers;
+        std::vector<std::pair<std::string, std::string>> headers; // sent in this order
         std::string body;
 
+        // With a file, the body is each segment's prefix followed by its
+        // byte range, sent straight from the descriptor, then body itself
+        struct file_segment
+        {
+            std::string prefix;
+            std::uint64_t offset{0};
+            std::uint64_t length{0};
+        };
+        std::shared_ptr<const open_file> file;
+        std::vector<file_segment> segments;
+
+        // Replaces a field of the same name (case-insensitively) or appends one
+        void set_header(std::string_view name, std::string_view value);
+
+        // Sends length bytes of f starting at offset as the whole body
+        void send_file(std::shared_ptr<const open_file> f, std::uint64_t offset, std::uint64_t length);
+
+        // Sends several ranges of f as multipart/byteranges, each part
+        // labelled with content_type and its Content-Range
+        void send_file_ranges(std::shared_ptr<const open_file> f, std::span<const byte_range> ranges,
+                              std::string_view content_type);
+
+        std::uint64_t content_length() const noexcept;
+
+        // Drops the body and any file but keeps the fields, Content-Length
+        // included, as a response to HEAD must
+        void drop_body();
+
+        // When set, replaces status, body and any file; only the fields in
+        // headers (such as Connection) are written alongside it
+        std::shared_ptr<const serialized_response> serialized;
+
+        // Everything but Connection and Date, for an in-memory body
+        std::shared_ptr<const serialized_response> serialize() const;
+
+        // Appends the status line and header fields, blank line included.
+        // Content-Length, Date and Server are added unless already set.
+        void write_head(std::string &out) const;
+        // Head and in-memory body; a file body is not included
         std::string to_string() const;
     };
 
+    // Connection and byte counters of one core's share of a server
+    struct traffic_stats
+    {
+        std::uint64_t connections_opened{0};
+        std::uint64_t connections_closed{0};
+        std::uint64_t bytes_in{0};  // read from clients
+        std::uint64_t bytes_out{0}; // responses queued for sending, heads included
+    };
+
     class server
     {
     public:
@@ -42,26 +123,67 @@ namespace swiftnet::http
 
         void route(const std::string &method, const std::string &path, handler_t h);
 
+        // Opens one SO_REUSEPORT listener per scheduler core; call before start().
+        void set_per_core_accept(bool enabled);
+
+        // Closes a connection that sends nothing (or accepts no response
+        // bytes) for this long; zero disables. Call before start().
+        void set_idle_timeout(std::chrono::milliseconds timeout);
+
+        // Largest request body accepted; bigger ones get 413 before being read
+        void set_max_body_size(std::size_t bytes);
+
         void start(std::size_t threads = std::thread::hardware_concurrency());
         void stop();
 
+        // One entry per scheduler core, then one for other threads; empty
+        // before start(). A connection may close on a different core than
+        // it opened on, so only the sums are meaningful.
+        std::vector<traffic_stats> traffic() const;
+
     private:
         struct route_key
         {
             std::string method;
             std::string path;
-            bool operator<(const route_key &o) const noexcept
+        };
+        // Lets a request's method and path find a route without copying them
+        struct route_view
+        {
+            std::string_view method;
+            std::string_view path;
+        };
+        struct route_less
+        {
+            using is_transparent = void;
+            template <typename A, typename B>
+            bool operator()(const A &a, const B &b) const noexcept
             {
-                return method < o.method || (method == o.method && path < o.path);
+                std::string_view am = a.method, bm = b.method;
+                return am < bm || (am == bm && std::string_view(a.path) < std::string_view(b.path));
             }
         };
 
         vthread client_task(net::tcp_socket sock);
 
+        // Each core counts into its own cache line
+        struct alignas(64) traffic_counters
+        {
+            std::atomic<std::uint64_t> opened{0};
+            std::atomic<std::uint64_t> closed{0};
+            std::atomic<std::uint64_t> bytes_in{0};
+            std::atomic<std::uint64_t> bytes_out{0};
+        };
+        std::vector<std::unique_ptr<traffic_counters>> traffic_;
+        traffic_counters &local_traffic() noexcept;
+
         net::acceptor acceptor_;
-        std::map<route_key, handler_t> routes_;
+        std::map<route_key, handler_t, route_less> routes_;
+        const handler_t *catch_all_{nullptr}; // the "*" "*" route, if any
         std::atomic<bool> running_{false};
-        std::atomic<bool> acceptor_supervisor_running_{false}; // Prevent multiple supervisors
+        bool per_core_accept_{true};
+        std::chrono::milliseconds idle_timeout_{60000};
+        std::size_t max_body_size_{8 * 1024 * 1024};
     };
 
 } // namespace swiftnet::http
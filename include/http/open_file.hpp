@@ -0,0 +1,57 @@
+#ifndef http_open_file_hpp
+#define http_open_file_hpp
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace swiftnet::http
+{
+
+    // What identifies a file's current contents, from one stat
+    struct file_identity
+    {
+        std::uint64_t device{0};
+        std::uint64_t inode{0};
+        std::uint64_t size{0};
+        std::int64_t mtime_ns{0}; // since the epoch
+
+        bool operator==(const file_identity &) const = default;
+    };
+
+    // Quoted strong entity-tag; changes whenever the path names another
+    // file or the file is rewritten
+    std::string strong_etag(const file_identity &id);
+
+    /* A regular file opened read-only for sending as a response body.
+     * Shared by reference count, so several responses can send from the
+     * same descriptor. Sends use explicit offsets and never move the file
+     * position. The descriptor is closed with the last reference.
+     */
+    class open_file
+    {
+    public:
+        // nullptr if path cannot be opened or is not a regular file
+        static std::shared_ptr<const open_file> open(const std::string &path);
+
+        // false if path does not name a regular file
+        static bool stat(const std::string &path, file_identity &id);
+
+        open_file(int fd, const file_identity &id) noexcept : fd_(fd), id_(id) {}
+        ~open_file();
+
+        open_file(const open_file &) = delete;
+        open_file &operator=(const open_file &) = delete;
+
+        int fd() const noexcept { return fd_; }
+        std::uint64_t size() const noexcept { return id_.size; }
+        const file_identity &identity() const noexcept { return id_; }
+
+    private:
+        int fd_;
+        file_identity id_;
+    };
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef http_parser_hpp
+#define http_parser_hpp
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace swiftnet::http
+{
+
+    struct request;
+
+    struct header_field
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    /* Incremental HTTP/1.1 request-head parser.
+     * parse() is handed the bytes of the current request received so far
+     * and picks up where the previous call stopped, so a head that arrives
+     * in pieces is scanned once in total. Only offsets are kept while the
+     * head is incomplete, which lets the caller grow or compact its buffer
+     * between calls. Line and colon delimiters are located 32 (AVX2) or 16
+     * (SSE4.2) bytes at a time.
+     *
+     * Once complete, fill() points a request's fields into the buffer; the
+     * views stay valid for as long as those bytes do.
+     */
+    class request_parser
+    {
+    public:
+        enum class result
+        {
+            incomplete,
+            complete,
+            bad_request,
+            too_large // head over max_head_bytes or more than max_headers fields
+        };
+
+        static constexpr std::size_t max_headers = 64;
+        static constexpr std::size_t max_head_bytes = 64 * 1024;
+
+        // data must start with the same bytes as in the previous call
+        result parse(const char *data, std::size_t len);
+
+        // Valid after parse() returned complete; data is the current buffer
+        void fill(request &req, const char *data);
+
+        // Length of the request line, header fields and the blank line
+        std::size_t head_size() const noexcept { return head_size_; }
+
+        void reset() noexcept;
+
+    private:
+        struct span
+        {
+            std::uint32_t off{0};
+            std::uint32_t len{0};
+        };
+
+        struct field
+        {
+            span name;
+            span value;
+        };
+
+        std::size_t pos_{0};        // next byte to scan
+        std::size_t line_start_{0}; // start of the line being scanned
+        std::size_t colon_{0};      // ':' of the current header line, 0 if not seen yet
+        std::size_t head_size_{0};
+        bool have_request_line_{false};
+
+        span method_;
+        span target_;
+        span version_;
+        int minor_version_{1};
+
+        std::size_t nfields_{0};
+        std::array<field, max_headers> fields_;
+        std::array<header_field, max_headers> views_;
+
+        bool parse_request_line(const char *data, std::size_t end);
+        bool add_field(const char *data, std::size_t end);
+    };
+
+    /* How a request body is delimited (RFC 9112 section 6). invalid covers
+     * conflicting or unparsable Content-Length, a Transfer-Encoding that
+     * does not end in chunked, and both headers at once.
+     */
+    struct body_framing
+    {
+        enum class kind
+        {
+            none,
+            length,
+            chunked,
+            invalid
+        };
+
+        kind type{kind::none};
+        std::uint64_t length{0};
+    };
+
+    body_framing framing_of(const request &req) noexcept;
+
+    /* Incremental, in-place chunked transfer decoder.
+     * decode() is handed the body region of the buffer (everything after
+     * the head) and continues where it stopped. Chunk payload is moved down
+     * over the framing, so the decoded body always sits at data[0, size()).
+     * While incomplete, reclaim() drops the framing already consumed and
+     * returns where the caller's next read should land.
+     */
+    class chunked_decoder
+    {
+    public:
+        enum class result
+        {
+            incomplete,
+            complete,
+            bad_request,
+            too_large
+        };
+
+        explicit chunked_decoder(std::uint64_t max_size) : max_size_(max_size) {}
+
+        result decode(char *data, std::size_t len);
+
+        std::size_t size() const noexcept { return out_; }
+        // Raw bytes the body took up, trailers included; valid once complete
+        std::size_t consumed() const noexcept { return in_; }
+
+        std::size_t reclaim() noexcept
+        {
+            in_ = out_;
+            return out_;
+        }
+
+    private:
+        enum class state
+        {
+            size,
+            extension,
+            size_lf,
+            data,
+            data_cr,
+            data_lf,
+            trailer_start,
+            trailer,
+            trailer_lf,
+            done
+        };
+
+        std::uint64_t max_size_;
+        state state_{state::size};
+        std::uint64_t chunk_{0}; // size being read, then payload left in the chunk
+        std::size_t digits_{0};
+        std::size_t line_len_{0}; // guards against endless extensions and trailers
+        std::size_t in_{0};
+        std::size_t out_{0};
+    };
+
+}
+
+#endif
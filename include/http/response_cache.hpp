@@ -0,0 +1,100 @@
+#ifndef http_response_cache_hpp
+#define http_response_cache_hpp
+
+#include "http_server.hpp"
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace swiftnet::http
+{
+
+    /* Serialized responses keyed by request-target plus the values of the
+     * request fields the response's Vary names, so a hit is written out
+     * without running a handler or formatting anything.
+     * Each scheduler core has its own shard (responses are cached once
+     * per core that serves them) with an equal part of the byte budget,
+     * evicting least recently used entries past it. Shards still lock,
+     * but only a revalidation stolen by another core ever contends.
+     * An entry is fresh for its TTL, then for its stale window is still
+     * served while one request per window is told to revalidate it.
+     * Requests carrying Authorization only hit entries stored as public
+     * (RFC 9111 section 3.5).
+     */
+    class response_cache
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // For store() and erase(): the calling core's shard
+        static constexpr std::size_t local = static_cast<std::size_t>(-1);
+
+        struct lookup
+        {
+            std::shared_ptr<const serialized_response> response; // nullptr on a miss
+            bool revalidate{false}; // stale: the caller should refresh it
+            std::size_t shard{local}; // where it was found, to store the refresh into
+        };
+
+        response_cache(std::size_t max_bytes, std::size_t shards);
+
+        response_cache(const response_cache &) = delete;
+        response_cache &operator=(const response_cache &) = delete;
+
+        lookup find(const request &req);
+
+        // Caches res for req. vary is the response's Vary field; "*" (or a
+        // response bigger than a shard's budget) is not cached. is_public
+        // lets requests with Authorization be served the entry.
+        void store(const request &req, std::string_view vary, std::shared_ptr<const serialized_response> res,
+                   clock::duration ttl, clock::duration stale, bool is_public, std::size_t shard = local);
+
+        // Drops whatever is cached for req, e.g. when revalidation failed
+        void erase(const request &req, std::size_t shard = local);
+
+    private:
+        struct entry
+        {
+            std::string key;
+            std::string target;
+            std::shared_ptr<const serialized_response> response;
+            std::size_t bytes;
+            clock::time_point fresh_until;
+            clock::time_point stale_until;
+            bool is_public;
+            bool revalidating{false};
+        };
+
+        // The Vary names last stored for a target, shared by its entries
+        struct variants
+        {
+            std::vector<std::string> names;
+            std::size_t entries{0};
+        };
+
+        struct shard
+        {
+            std::mutex mutex;
+            std::list<entry> lru; // most recently used first
+            std::unordered_map<std::string, std::list<entry>::iterator> index;
+            std::unordered_map<std::string, variants> vary;
+            std::size_t bytes{0};
+        };
+
+        std::size_t shard_budget_;
+        std::vector<std::unique_ptr<shard>> shards_;
+
+        std::size_t shard_of(std::string_view target, std::size_t hint) const noexcept;
+        static void make_key(std::string &key, const request &req, const std::vector<std::string> &names);
+        void remove(shard &s, std::list<entry>::iterator it);
+    };
+
+}
+
+#endif
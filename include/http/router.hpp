@@ -0,0 +1,72 @@
+#ifndef http_router_hpp
+#define http_router_hpp
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace swiftnet::http
+{
+
+    /* Compressed radix tree of route patterns, one tree per method.
+     * A pattern is static text with two kinds of capture:
+     *   :name  one non-empty path segment (up to the next '/')
+     *   *      the rest of the path, possibly empty; only as the last
+     *          character, captured under the name "*"
+     * Lookup walks the path once, preferring a static edge over a :param
+     * over a *, and only backtracks when a preferred branch dead-ends, so
+     * its cost follows the path length rather than the number of routes.
+     * Captures are views into the looked-up path.
+     */
+    class router
+    {
+    public:
+        static constexpr std::size_t max_params = 16;
+
+        struct param
+        {
+            std::string_view name;
+            std::string_view value;
+        };
+
+        struct match
+        {
+            std::size_t id{0};
+            std::size_t nparams{0};
+            std::array<param, max_params> params;
+        };
+
+        router();
+        ~router();
+        router(router &&) noexcept;
+        router &operator=(router &&) noexcept;
+
+        // Returns false when the same pattern is already registered for the
+        // method (the first registration keeps it). Throws std::runtime_error
+        // on a malformed pattern.
+        bool add(std::string_view method, std::string_view pattern, std::size_t id);
+
+        bool find(std::string_view method, std::string_view path, match &m) const;
+
+        struct node; // defined in router.cpp
+
+    private:
+        struct route_entry
+        {
+            std::size_t id;
+            std::vector<std::string> names; // capture names in path order
+        };
+
+        std::vector<std::pair<std::string, std::unique_ptr<node>>> trees_;
+        std::vector<route_entry> entries_;
+
+        const node *tree(std::string_view method) const noexcept;
+    };
+
+}
+
+#endif
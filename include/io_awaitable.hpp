@@ -2,34 +2,109 @@
 #define io_awaitable_hpp
 
 #include "detail/os_backend.hpp"
+#include "detail/timer_wheel.hpp"
+#include <atomic>
+#include <chrono>
 #include <coroutine>
-
-#if defined(SWIFTNET_BACKEND_IOURING)
-#include <liburing.h>
-#endif
+#include <cstddef>
+#include <cstdint>
 
 namespace swiftnet
 {
 
+    /* Suspends the calling vthread until fd becomes ready for poll_events
+     * (POLLIN / POLLOUT). The descriptor is registered edge-triggered with
+     * the current core's reactor on first use; readiness resumes the
+     * coroutine on that core without any helper threads.
+     * With a deadline the wait is raced against a timer on the current
+     * core's wheel; if the timer wins, await_resume() yields -ETIMEDOUT.
+     */
     class io_awaitable
     {
     public:
-        io_awaitable(int fd, unsigned poll_events, bool oneshot = true);
+        using clock = std::chrono::steady_clock;
+
+        io_awaitable(int fd, unsigned poll_events, clock::time_point deadline = {});
 
         bool await_ready() const noexcept { return false; }
-        void await_suspend(std::coroutine_handle<> h);
-        int await_resume();
+        bool await_suspend(std::coroutine_handle<> h);
+        int await_resume() const noexcept { return res_; }
+
+        // Called by the owning core's reactor when readiness is observed.
+        void complete(int res);
+
+        // Called by the scheduler just before the frame is parked on slot,
+        // and to undo that if it is not parked after all.
+        bool arm_deadline(std::atomic<std::uintptr_t> &slot);
+        void disarm_deadline();
 
     private:
         int fd_;
         unsigned events_;
-        bool oneshot_;
         int res_{0};
         std::coroutine_handle<> handle_;
+        clock::time_point deadline_;
+        std::atomic<std::uintptr_t> *slot_{nullptr};
+        detail::timer_node timer_;
+
+        static void on_deadline(detail::timer_node *t);
+    };
+
+    /* Submits one recv/send/sendmsg to the current core's io_uring and resumes the
+     * coroutine from its CQE; await_resume() yields the CQE result (bytes
+     * transferred or -errno). Without a ring on this core nothing is
+     * submitted and the result is -ENOSYS, so callers can fall back.
+     * A deadline is submitted as a linked timeout; an operation cut short
+     * by it yields -ETIMEDOUT.
+     */
+    class completion_awaitable
+    {
+    public:
+        enum class op_kind
+        {
+            recv,
+            send,
+            sendmsg // buf is a msghdr, len unused
+        };
+
+        using clock = std::chrono::steady_clock;
 
-        // New simplified I/O polling implementation
-        bool check_immediate_availability();
-        void start_io_polling();
+        completion_awaitable(op_kind kind, int fd, void *buf, std::size_t len, clock::time_point deadline = {});
+
+        static completion_awaitable recv(int fd, void *buf, std::size_t len, clock::time_point deadline = {})
+        {
+            return {op_kind::recv, fd, buf, len, deadline};
+        }
+        static completion_awaitable send(int fd, const void *buf, std::size_t len, clock::time_point deadline = {})
+        {
+            return {op_kind::send, fd, const_cast<void *>(buf), len, deadline};
+        }
+#if defined(SWIFTNET_HAS_LIBURING)
+        // msg and the buffers it points to must stay put until resumed
+        static completion_awaitable sendmsg(int fd, const msghdr *msg, clock::time_point deadline = {})
+        {
+            return {op_kind::sendmsg, fd, const_cast<msghdr *>(msg), 0, deadline};
+        }
+#endif
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        int await_resume() const noexcept { return res_; }
+
+        // Called by the owning core's io_context when the CQE is reaped.
+        void complete(int res);
+
+    private:
+        op_kind kind_;
+        int fd_;
+        void *buf_;
+        std::size_t len_;
+        int res_{0};
+        std::coroutine_handle<> handle_;
+        clock::time_point deadline_;
+#if defined(SWIFTNET_HAS_LIBURING)
+        __kernel_timespec timeout_{}; // read by the kernel at submission
+#endif
     };
 
 }
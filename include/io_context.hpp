@@ -3,16 +3,23 @@
 
 #include "detail/os_backend.hpp"
 #include <atomic>
+#include <memory>
 #include <thread>
 #include <vector>
 
-#if defined(SWIFTNET_BACKEND_IOURING)
+#if defined(SWIFTNET_HAS_LIBURING)
 #include <liburing.h>
 #endif
 
 namespace swiftnet
 {
 
+    /* Completion-based I/O backend: one io_uring per scheduler core.
+     * Rings are created disabled by start() and enabled by attach() on the
+     * worker thread that owns them, so every ring has a single issuer.
+     * SQEs are prepared by coroutines running on that core, flushed by the
+     * worker between tasks, and CQEs are reaped by the same worker.
+     */
     class io_context
     {
     public:
@@ -22,21 +29,39 @@ namespace swiftnet
         void start(std::size_t threads = std::thread::hardware_concurrency());
         void stop();
 
-#if defined(SWIFTNET_BACKEND_IOURING)
+        // True once ring idx has been attached by its worker
+        bool enabled(std::size_t idx) const noexcept;
+
+#if defined(SWIFTNET_HAS_LIBURING)
         io_uring &ring(std::size_t idx);
         std::size_t rings() const { return rings_.size(); }
+
+        // Worker-side hooks; idx must be the calling worker's core.
+        // attach() returns the eventfd signalled on new completions, or -1.
+        int attach(std::size_t idx);
+        io_uring_sqe *get_sqe(std::size_t idx);
+        void flush(std::size_t idx);
+        void reap(std::size_t idx);
 #else
         std::size_t rings() const { return 0; }
+        int attach(std::size_t) { return -1; }
+        void flush(std::size_t) {}
+        void reap(std::size_t) {}
 #endif
 
     private:
         io_context() = default;
-        void poll_loop(std::size_t idx);
 
-#if defined(SWIFTNET_BACKEND_IOURING)
-        std::vector<io_uring> rings_;
+#if defined(SWIFTNET_HAS_LIBURING)
+        struct ring_state
+        {
+            io_uring ring{};
+            int event_fd{-1};
+            unsigned pending{0};
+            std::atomic<bool> attached{false};
+        };
+        std::vector<std::unique_ptr<ring_state>> rings_;
 #endif
-        std::vector<std::thread> pollers_;
         std::atomic<bool> running_{false};
     };
 
@@ -0,0 +1,102 @@
+#ifndef log_hpp
+#define log_hpp
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <spdlog/fmt/fmt.h>
+
+namespace swiftnet::logging
+{
+
+    enum class level : int
+    {
+        trace,
+        debug,
+        info,
+        warn,
+        error,
+        critical,
+        off
+    };
+
+    /* Levels below SWIFTNET_LOG_LEVEL are compiled out: the SWIFTNET_LOG_*
+     * macros for them expand to nothing that runs, arguments included.
+     * Defaults to debug, or info when NDEBUG is defined.
+     */
+#ifndef SWIFTNET_LOG_LEVEL
+#ifdef NDEBUG
+#define SWIFTNET_LOG_LEVEL 2
+#else
+#define SWIFTNET_LOG_LEVEL 1
+#endif
+#endif
+
+    constexpr bool compiled(level l) noexcept
+    {
+        return static_cast<int>(l) >= SWIFTNET_LOG_LEVEL;
+    }
+
+    // Runtime threshold for the levels compiled in (default info)
+    void set_level(level l) noexcept;
+    level get_level() noexcept;
+    bool enabled(level l) noexcept;
+
+    /* Enabled messages are formatted into a fixed-size record on the
+     * caller's per-core ring, lock-free, and a background writer hands
+     * them to the sink. A full ring drops the message (the writer reports
+     * how many) rather than stall a core. Messages longer than
+     * max_message are cut short.
+     */
+    constexpr std::size_t max_message = 480;
+
+    using clock = std::chrono::system_clock;
+    using sink_t = std::function<void(level, clock::time_point, std::string_view)>;
+
+    // The sink runs on the writer thread; nullptr restores the stderr one
+    void set_sink(sink_t sink);
+
+    // An already formatted message
+    void emit(level l, std::string_view message) noexcept;
+
+    template <typename... Args>
+    void write(level l, fmt::format_string<Args...> format, Args &&...args) noexcept
+    {
+        char buf[max_message];
+        try
+        {
+            auto r = fmt::format_to_n(buf, sizeof(buf), format, std::forward<Args>(args)...);
+            emit(l, std::string_view(buf, std::min(r.size, sizeof(buf))));
+        }
+        catch (...)
+        {
+            emit(l, "(unformattable log message)");
+        }
+    }
+
+    // Blocks until everything logged so far has reached the sink
+    void flush();
+
+}
+
+#define SWIFTNET_LOG(lvl, ...)                                                              \
+    do                                                                                      \
+    {                                                                                       \
+        if constexpr (::swiftnet::logging::compiled(::swiftnet::logging::level::lvl))       \
+        {                                                                                   \
+            if (::swiftnet::logging::enabled(::swiftnet::logging::level::lvl))              \
+                ::swiftnet::logging::write(::swiftnet::logging::level::lvl, __VA_ARGS__);   \
+        }                                                                                   \
+    } while (0)
+
+#define SWIFTNET_LOG_TRACE(...) SWIFTNET_LOG(trace, __VA_ARGS__)
+#define SWIFTNET_LOG_DEBUG(...) SWIFTNET_LOG(debug, __VA_ARGS__)
+#define SWIFTNET_LOG_INFO(...) SWIFTNET_LOG(info, __VA_ARGS__)
+#define SWIFTNET_LOG_WARN(...) SWIFTNET_LOG(warn, __VA_ARGS__)
+#define SWIFTNET_LOG_ERROR(...) SWIFTNET_LOG(error, __VA_ARGS__)
+#define SWIFTNET_LOG_CRITICAL(...) SWIFTNET_LOG(critical, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef metrics_hpp
+#define metrics_hpp
+
+#include "http/http_server.hpp"
+#include "vthread_scheduler.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace swiftnet::metrics
+{
+
+    /* Log-linear (HDR) histogram of nanosecond values: exact below 8,
+     * then 8 buckets per power of two, so any value is placed within
+     * 12.5% of itself. Recording is one relaxed add on the bucket and one
+     * on the sum; the histogram is meant to have a single core writing it.
+     * Values from 2^max_exponent ns (about 18 minutes) up share the last
+     * bucket.
+     */
+    class histogram
+    {
+    public:
+        static constexpr unsigned sub_bucket_bits = 3;
+        static constexpr unsigned sub_buckets = 1u << sub_bucket_bits;
+        static constexpr unsigned max_exponent = 40;
+        static constexpr std::size_t bucket_count = (max_exponent - sub_bucket_bits + 1) * sub_buckets;
+
+        static std::size_t bucket_of(std::uint64_t v) noexcept;
+        // Smallest value that lands in bucket i
+        static std::uint64_t bucket_floor(std::size_t i) noexcept;
+
+        void record(std::uint64_t v) noexcept
+        {
+            counts_[bucket_of(v)].fetch_add(1, std::memory_order_relaxed);
+            sum_.fetch_add(v, std::memory_order_relaxed);
+        }
+
+        // Sums of any number of histograms, taken bucket by bucket while
+        // they are written; each bucket is exact, the set need not be
+        struct snapshot
+        {
+            std::array<std::uint64_t, bucket_count> counts{};
+            std::uint64_t count{0};
+            std::uint64_t sum{0};
+
+            // Values below v, to within the bucket v falls in
+            std::uint64_t count_below(std::uint64_t v) const noexcept;
+            // Upper edge of the bucket holding the q-th quantile
+            std::uint64_t quantile(double q) const noexcept;
+        };
+
+        void add_to(snapshot &s) const noexcept;
+
+    private:
+        std::array<std::atomic<std::uint64_t>, bucket_count> counts_{};
+        std::atomic<std::uint64_t> sum_{0};
+    };
+
+    /* Request latency per route and status class, kept per core: a core
+     * records into its own histograms, allocated the first time it sees
+     * a series, and a scrape sums them. Threads other than the
+     * scheduler's workers share one extra set.
+     */
+    class request_metrics
+    {
+    public:
+        // Route ids index routes, given as {method, pattern}
+        request_metrics(std::vector<std::pair<std::string, std::string>> routes, std::size_t cores);
+        ~request_metrics();
+
+        request_metrics(const request_metrics &) = delete;
+        request_metrics &operator=(const request_metrics &) = delete;
+
+        // route past the table (such as no route matched) counts as unmatched
+        void observe(std::size_t route, int status, std::uint64_t latency_ns) noexcept;
+
+        // Appends swiftnet_http_request_duration_seconds in Prometheus
+        // text format
+        void write(std::string &out) const;
+
+    private:
+        static constexpr std::size_t status_classes = 5; // 1xx to 5xx
+
+        struct core_series
+        {
+            std::unique_ptr<std::atomic<histogram *>[]> series; // [route][class]
+        };
+
+        std::vector<std::pair<std::string, std::string>> routes_;
+        std::size_t series_count_;
+        std::vector<core_series> cores_; // one per core, then the shared one
+    };
+
+    // Prometheus text format for the scheduler's and the server's counters,
+    // labelled by core where they are kept per core
+    void write_scheduler(std::string &out, const vthread_scheduler::Stats &stats);
+    void write_traffic(std::string &out, const std::vector<http::traffic_stats> &traffic);
+
+    // Content-Type of the text exposition format
+    constexpr std::string_view content_type = "text/plain; version=0.0.4; charset=utf-8";
+
+}
+
+#endif
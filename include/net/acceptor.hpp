@@ -4,19 +4,40 @@
 #include "../vthread.hpp"
 #include "tcp_socket.hpp"
 #include <functional>
+#include <vector>
 
 namespace swiftnet::net
 {
 
+    /* Listening socket(s) bound to a single port.
+     * By default one listener is opened. open_per_core() adds further
+     * SO_REUSEPORT listeners on the same port so that each scheduler core
+     * can run its own accept loop and the kernel spreads incoming
+     * connections across them.
+     */
     class acceptor
     {
     public:
         explicit acceptor(uint16_t port, int backlog = 1024);
         ~acceptor();
+
+        acceptor(const acceptor &) = delete;
+        acceptor &operator=(const acceptor &) = delete;
+
+        // Grows to n listeners; returns the count actually open (1 without SO_REUSEPORT).
+        std::size_t open_per_core(std::size_t n);
+        std::size_t listeners() const noexcept { return listen_fds_.size(); }
+        int listener_fd(std::size_t idx) const { return listen_fds_.at(idx); }
+
         swiftnet::vthread async_accept(std::function<void(tcp_socket)> cb);
+        swiftnet::vthread async_accept(std::size_t idx, std::function<void(tcp_socket)> cb);
 
     private:
-        int listen_fd_;
+        std::vector<int> listen_fds_;
+        uint16_t port_;
+        int backlog_;
+
+        int open_listener();
         void set_nonblock(int fd);
     };
 
@@ -3,6 +3,8 @@
 
 #include "../io_awaitable.hpp"
 #include "../vthread.hpp"
+#include <chrono>
+#include <cstdint>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -19,12 +21,31 @@ namespace swiftnet::net
 
         int fd() const { return fd_; }
         void close();
+        // Sends FIN but keeps reading, e.g. to drain an upload that was refused
+        void shutdown_write();
 
+        // Returns the bytes read (0 on EOF, -1 on error) once any data is available
         vthread_base<int> async_read(void *buf, std::size_t len);
+        // Returns len once everything is written, -1 on error
         vthread_base<int> async_write(const void *buf, std::size_t len);
+        // Gathered write of all count buffers with as few syscalls as the
+        // socket allows. iov is advanced past what was sent as it goes.
+        // Returns the total written once done, -1 on error.
+        vthread_base<int> async_writev(iovec *iov, std::size_t count);
+        // Sends length bytes of file_fd from offset without copying them
+        // through user space (sendfile(2)); the file position is untouched.
+        // Returns 0 once done, -1 on error or if the file ends early.
+        vthread_base<int> async_sendfile(int file_fd, std::uint64_t offset, std::uint64_t length);
+
+        // Per-operation deadlines, zero to wait forever. An operation that
+        // runs out of time returns -1 with errno set to ETIMEDOUT.
+        void set_read_timeout(std::chrono::milliseconds t) noexcept { read_timeout_ = t; }
+        void set_write_timeout(std::chrono::milliseconds t) noexcept { write_timeout_ = t; }
 
     private:
         int fd_;
+        std::chrono::milliseconds read_timeout_{0};
+        std::chrono::milliseconds write_timeout_{0};
         void set_nonblock();
     };
 
@@ -1,12 +1,17 @@
 #ifndef SWIFTNET_HPP
 #define SWIFTNET_HPP
 
+#include "http/access_log.hpp"
+#include "http/file_cache.hpp"
 #include "http/http_server.hpp"
+#include "http/response_cache.hpp"
+#include "http/router.hpp"
+#include "metrics.hpp"
 #include "net/tcp_socket.hpp"
+#include "timer.hpp"
 #include "vthread.hpp"
 #include <functional>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -14,6 +19,7 @@
 #include <filesystem>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
+#include <spdlog/async_logger.h>
 #include <condition_variable>
 #include <mutex>
 
@@ -41,7 +47,7 @@ namespace swiftnet
         const std::string &body() const { return body_; }
         const std::unordered_map<std::string, std::string> &headers() const { return headers_; }
 
-        // Get header value
+        // Get header value; the name is matched case-insensitively
         std::string header(const std::string &name) const;
 
         // Get query parameter
@@ -50,6 +56,8 @@ namespace swiftnet
         // Get route parameter (set by router)
         std::string param(const std::string &name) const;
         void set_param(const std::string &name, const std::string &value);
+        // Captures must view path()
+        void set_params(const http::router::match &m);
 
         // JSON parsing
         bool is_json() const;
@@ -71,6 +79,16 @@ namespace swiftnet
         mutable Json json_cache_;
         mutable bool json_parsed_{false};
 
+        // Router captures as offsets into path_, so copies stay valid
+        struct capture
+        {
+            std::string_view name;
+            size_t offset;
+            size_t length;
+        };
+        std::array<capture, http::router::max_params> captures_;
+        size_t ncaptures_{0};
+
         void parse_query_string();
     };
 
@@ -92,7 +110,14 @@ namespace swiftnet
         Response &text(const std::string &content);
         Response &html(const std::string &content);
         Response &json(const Json &data);
+        // Files carry a strong ETag and Last-Modified; a GET that already
+        // has the current version gets 304 without the file being opened.
+        // A GET with Range gets 206 with just those bytes (several ranges
+        // as multipart/byteranges), or 416 if none lie within the file.
+        // Files from static_files with a .br or .gz sibling are sent
+        // precompressed to clients that accept it.
         Response &file(const std::string &filepath);
+        Response &file(std::shared_ptr<const http::cached_file> f);
         Response &send(const std::string &content);
 
         // Convenience methods
@@ -118,6 +143,21 @@ namespace swiftnet
         int status_;
         std::unordered_map<std::string, std::string> headers_;
         std::string body_;
+        std::shared_ptr<const http::cached_file> file_; // sent instead of body_ when set
+        std::string file_path_;                         // stat'ed but opened only if sent
+        std::string etag_;
+        std::time_t last_modified_{0};
+        std::vector<http::byte_range> ranges_; // of file_, for a 206
+
+        friend class SwiftNet;
+        void set_validators(std::string etag, std::time_t last_modified);
+        void drop_file();
+        void vary_on_encoding();
+        // Settles a file body against the request: pick a precompressed
+        // sibling, then 304, or open it and apply any Range
+        void finish(const Request &req);
+        // Compresses a large enough text body as Accept-Encoding allows
+        void encode(const Request &req, size_t min_size);
     };
 
     // Route structure
@@ -125,9 +165,19 @@ namespace swiftnet
     {
         std::string method;
         std::string pattern;
-        std::regex regex;
-        std::vector<std::string> param_names;
         handler_t handler;
+
+        // Middleware that can run for this route, in order; resolved by listen()
+        struct Link
+        {
+            const middleware_t *middleware;
+            std::string prefix; // empty when it always runs, else checked per request
+        };
+        std::vector<Link> chain;
+
+        // Set by SwiftNet::cache(); GET responses are cached while ttl is nonzero
+        std::chrono::milliseconds cache_ttl{0};
+        std::chrono::milliseconds cache_stale{0};
     };
 
     // SwiftNet class
@@ -158,6 +208,31 @@ namespace swiftnet
         SwiftNet &json(size_t limit = 1024 * 1024); // 1MB default
         SwiftNet &logger();
 
+        // Binary access log: one fixed-size record per request (time,
+        // method, route, status, body bytes, latency, core) queued on the
+        // serving core and written to path by a background thread, rotated
+        // to path.1, path.2, ... past max_file_bytes. Far cheaper than
+        // logger(); render the files with the swiftnet_access_log tool.
+        SwiftNet &access_log(const std::string &path, size_t max_file_bytes = 64 * 1024 * 1024,
+                             size_t max_files = 8);
+
+        // Prometheus metrics on GET path: latency histograms per route and
+        // status class, connections, bytes in and out, and per-core
+        // scheduler counters. Each core counts into its own memory; the
+        // totals are only added up when the endpoint is scraped.
+        SwiftNet &metrics(const std::string &path = "/metrics");
+
+        // Response cache: 200 responses to GETs on the route registered
+        // with this pattern are kept serialized for ttl, and replayed
+        // without running middleware or the handler. For stale_while_revalidate
+        // after that they are still served while the route runs again in the
+        // background. Responses with Set-Cookie or Cache-Control no-store or
+        // private are not cached. Requests with Authorization are neither
+        // cached nor served from the cache unless the response has
+        // Cache-Control public (RFC 9111 section 3.5).
+        SwiftNet &cache(const std::string &pattern, std::chrono::milliseconds ttl,
+                        std::chrono::milliseconds stale_while_revalidate = {});
+
         // Server control
         void listen(std::function<void()> callback = nullptr);
         void listen(uint16_t port, std::function<void()> callback = nullptr);
@@ -166,11 +241,44 @@ namespace swiftnet
         // Configuration
         SwiftNet &set_threads(size_t threads);
         SwiftNet &set_backlog(int backlog);
+        SwiftNet &set_per_core_accept(bool enabled);
+        SwiftNet &set_idle_timeout(std::chrono::milliseconds timeout);
+        SwiftNet &set_max_body_size(size_t bytes);
+        // Open files kept by static_files, and how long a cached file is
+        // trusted before one stat() revalidates it; call before static_files
+        SwiftNet &set_file_cache(size_t max_entries, std::chrono::milliseconds ttl);
+        // gzip/brotli/zstd for text bodies of at least min_size bytes, when
+        // the client accepts it (on by default)
+        SwiftNet &set_compression(bool enabled, size_t min_size = 1024);
+        // Memory for cached responses, split evenly across cores
+        SwiftNet &set_response_cache(size_t max_bytes);
 
     private:
         uint16_t port_;
         size_t threads_;
         int backlog_;
+        bool per_core_accept_{true};
+        std::chrono::milliseconds idle_timeout_{60000};
+        size_t max_body_size_{8 * 1024 * 1024};
+        size_t file_cache_entries_{4096};
+        std::chrono::milliseconds file_cache_ttl_{2000};
+        std::shared_ptr<http::file_cache> file_cache_;
+        bool compression_{true};
+        size_t compression_min_size_{1024};
+        size_t response_cache_bytes_{64 * 1024 * 1024};
+        std::shared_ptr<http::response_cache> response_cache_;
+
+        struct CacheRule
+        {
+            std::string pattern;
+            std::chrono::milliseconds ttl;
+            std::chrono::milliseconds stale;
+        };
+        std::vector<CacheRule> cache_rules_;
+        http::access_log::options access_log_options_;
+        std::unique_ptr<http::access_log> access_log_;
+        bool metrics_enabled_{false};
+        std::unique_ptr<metrics::request_metrics> request_metrics_;
         bool running_;
         
         // Blocking mechanism for listen()
@@ -179,15 +287,25 @@ namespace swiftnet
         bool shutdown_requested_{false};
 
         std::vector<Route> routes_;
+        http::router router_;
         std::vector<middleware_t> middlewares_;
         std::vector<std::pair<std::string, middleware_t>> path_middlewares_;
         std::unique_ptr<http::server> server_;
 
         void handle_request(const http::request &req, http::response &res);
-        bool match_route(const Route &route, const std::string &method,
-                        const std::string &path, Request &request);
-        Route create_route(const std::string &method, const std::string &pattern, handler_t handler);
-        void apply_middlewares(Request &req, Response &res, handler_t final_handler);
+        // Routes req and runs it; the route matched, or nullptr
+        const Route *dispatch(Request &req, Response &res);
+        bool cache_response(const http::request &req, http::response &res, const Route &route, size_t shard);
+        vthread revalidate(std::string target, std::vector<std::pair<std::string, std::string>> fields, size_t shard);
+        void resolve_cache_rules();
+        // Access log record and latency metrics for a finished request.
+        // route is what dispatch() matched, or for a cache hit what the
+        // path without its query matches; nullptr counts as unmatched.
+        void observe(const http::request &req, const http::response &res, const Route *route,
+                     std::chrono::steady_clock::time_point start, bool cached);
+        SwiftNet &add_route(const std::string &method, const std::string &pattern, handler_t handler);
+        void resolve_middlewares();
+        void apply_middlewares(Request &req, Response &res, const Route &route);
     };
 
     // Utility functions
@@ -228,7 +346,9 @@ namespace swiftnet
         };
     }
 
-    // Logger singleton
+    // Logger singleton: messages take the logging facade's per-core rings
+    // (and its runtime level), and its writer hands them to an async
+    // spdlog logger, so formatting and terminal I/O stay off the workers
     class Logger
     {
     public:
@@ -240,6 +360,8 @@ namespace swiftnet
 
     private:
         Logger();
+        ~Logger();
+        std::shared_ptr<spdlog::details::thread_pool> pool_;
         std::shared_ptr<spdlog::logger> logger_;
     };
 
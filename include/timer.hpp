@@ -0,0 +1,48 @@
+#ifndef timer_hpp
+#define timer_hpp
+
+#include "detail/timer_wheel.hpp"
+#include <chrono>
+#include <coroutine>
+
+namespace swiftnet
+{
+
+    /* Parks the calling vthread on the current core's timer wheel until the
+     * deadline passes; the core runs other work meanwhile. Outside a worker
+     * thread there is nothing to hand the frame to, so the calling thread
+     * simply blocks until the deadline.
+     */
+    class sleep_awaitable
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        explicit sleep_awaitable(clock::time_point deadline) : deadline_(deadline) {}
+
+        bool await_ready() const noexcept { return deadline_ <= clock::now(); }
+        bool await_suspend(std::coroutine_handle<> h);
+        void await_resume() const noexcept {}
+
+    private:
+        clock::time_point deadline_;
+        std::coroutine_handle<> handle_;
+        detail::timer_node timer_;
+
+        static void on_expiry(detail::timer_node *t);
+    };
+
+    inline sleep_awaitable sleep_until(std::chrono::steady_clock::time_point deadline)
+    {
+        return sleep_awaitable(deadline);
+    }
+
+    template <typename Rep, typename Period>
+    sleep_awaitable sleep_for(std::chrono::duration<Rep, Period> d)
+    {
+        return sleep_awaitable(std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(d));
+    }
+
+}
+
+#endif
@@ -1,17 +1,95 @@
 #ifndef vthread_hpp
 #define vthread_hpp
 
+#include "detail/frame_pool.hpp"
+#include <chrono>
 #include <coroutine>
+#include <cstdint>
 #include <exception>
 
 namespace swiftnet
 {
 
+    // Suspension reasons for virtual threads
+    enum class SuspendReason {
+        NONE,
+        IO_WAIT,
+        YIELD,
+        COMPLETED,
+        PREEMPTED
+    };
+
+    // Virtual thread execution context, kept in the coroutine frame
+    struct VThreadContext {
+        SuspendReason suspend_reason{SuspendReason::NONE};
+        std::chrono::steady_clock::time_point last_resume{};
+        std::chrono::steady_clock::time_point enqueued_at{};
+        uint64_t cpu_time_us{0};
+        uint32_t core_affinity{0};
+        bool is_mounted{false};
+    };
+
+    namespace detail
+    {
+
+        /* Common base of every vthread promise.
+         * It sits at offset 0 of the promise and all promise types share its
+         * alignment, so the scheduler can reach it from a type-erased handle
+         * without a lookup. Frames are allocated from the per-core frame_pool.
+         *
+         * Awaiting a child vthread links it into its parent's chain: the
+         * child records the parent as its continuation and shares the
+         * chain's root. Only roots are queued on the scheduler; `active` on
+         * the root is the innermost frame to resume, and the scheduling
+         * context lives on the root too.
+         */
+        struct promise_base
+        {
+            VThreadContext context;
+            promise_base *root{this};
+            std::coroutine_handle<> continuation{}; // awaiting parent, null for a root
+            std::coroutine_handle<> active{};       // root only: frame to resume, null for itself
+
+            static void *operator new(std::size_t size) { return frame_pool::allocate(size); }
+            static void operator delete(void *p) noexcept { frame_pool::deallocate(p); }
+
+            static promise_base &from(std::coroutine_handle<> h) noexcept
+            {
+                return std::coroutine_handle<promise_base>::from_address(h.address()).promise();
+            }
+
+            std::coroutine_handle<> handle() noexcept
+            {
+                return std::coroutine_handle<promise_base>::from_promise(*this);
+            }
+
+            // Scheduling state of the chain h belongs to
+            static VThreadContext &context_of(std::coroutine_handle<> h) noexcept
+            {
+                return from(h).root->context;
+            }
+
+            // Handle to queue when any frame of h's chain becomes runnable
+            static std::coroutine_handle<> root_of(std::coroutine_handle<> h) noexcept
+            {
+                return from(h).root->handle();
+            }
+
+            // Frame the scheduler resumes for root handle h
+            static std::coroutine_handle<> resume_point(std::coroutine_handle<> h) noexcept
+            {
+                promise_base &r = from(h);
+                return r.active ? r.active : h;
+            }
+        };
+
+    }
+
     template<typename T = void>
     class vthread_base
     {
     public:
-        struct promise_type
+        struct promise_type : detail::promise_base
         {
             T result_;
 
@@ -26,8 +104,9 @@ namespace swiftnet
             {
                 bool await_ready() const noexcept { return false; }
 
+                // Transfers to the awaiting parent, or back to the scheduler for a root
                 template <typename H>
-                void await_suspend(H h) noexcept;
+                std::coroutine_handle<> await_suspend(H h) noexcept;
 
                 void await_resume() noexcept {}
             };
@@ -41,6 +120,7 @@ namespace swiftnet
         };
 
         using handle_type = std::coroutine_handle<promise_type>;
+        static_assert(alignof(promise_type) == alignof(detail::promise_base), "promise_base::context_of relies on a common promise offset");
 
         // Default constructor for safe empty state
         vthread_base() noexcept : coro_{} {}
@@ -79,6 +159,14 @@ namespace swiftnet
 
         handle_type handle() const { return coro_; }
 
+        // Give up ownership of the frame without destroying it
+        handle_type release() noexcept
+        {
+            auto h = coro_;
+            coro_ = {};
+            return h;
+        }
+
         // Get result for non-void types
         T result() const { return coro_.promise().result_; }
 
@@ -88,13 +176,16 @@ namespace swiftnet
             return !coro_ || coro_.done(); 
         }
 
-        template<typename H>
-        void await_suspend(H) noexcept 
+        // Symmetric transfer into the child; its final_suspend jumps back here
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> parent) noexcept 
         {
-            // Schedule the coroutine to run
-            if (coro_ && !coro_.done()) {
-                resume();
-            }
+            detail::promise_base &p = parent.promise();
+            auto &child = coro_.promise();
+            child.continuation = parent;
+            child.root = p.root;
+            p.root->active = coro_;
+            return coro_;
         }
 
         T await_resume() 
@@ -119,7 +210,7 @@ namespace swiftnet
     class vthread_base<void>
     {
     public:
-        struct promise_type
+        struct promise_type : detail::promise_base
         {
             auto get_return_object() noexcept
             {
@@ -132,8 +223,9 @@ namespace swiftnet
             {
                 bool await_ready() const noexcept { return false; }
 
+                // Transfers to the awaiting parent, or back to the scheduler for a root
                 template <typename H>
-                void await_suspend(H h) noexcept;
+                std::coroutine_handle<> await_suspend(H h) noexcept;
 
                 void await_resume() noexcept {}
             };
@@ -147,6 +239,7 @@ namespace swiftnet
         };
 
         using handle_type = std::coroutine_handle<promise_type>;
+        static_assert(alignof(promise_type) == alignof(detail::promise_base), "promise_base::context_of relies on a common promise offset");
 
         // Default constructor for safe empty state
         vthread_base() noexcept : coro_{} {}
@@ -185,19 +278,30 @@ namespace swiftnet
 
         handle_type handle() const { return coro_; }
 
+        // Give up ownership of the frame without destroying it
+        handle_type release() noexcept
+        {
+            auto h = coro_;
+            coro_ = {};
+            return h;
+        }
+
         // Awaiter interface
         bool await_ready() const noexcept 
         { 
             return !coro_ || coro_.done(); 
         }
 
-        template<typename H>
-        void await_suspend(H) noexcept 
+        // Symmetric transfer into the child; its final_suspend jumps back here
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> parent) noexcept 
         {
-            // Schedule the coroutine to run
-            if (coro_ && !coro_.done()) {
-                resume();
-            }
+            detail::promise_base &p = parent.promise();
+            auto &child = coro_.promise();
+            child.continuation = parent;
+            child.root = p.root;
+            p.root->active = coro_;
+            return coro_;
         }
 
         void await_resume() noexcept 
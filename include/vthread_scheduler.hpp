@@ -1,18 +1,18 @@
 #ifndef vthread_scheduler_hpp
 #define vthread_scheduler_hpp
 
+#include "detail/fd_table.hpp"
 #include "detail/mpsc_queue.hpp"
+#include "detail/timer_wheel.hpp"
+#include "detail/ws_deque.hpp"
 #include "vthread.hpp"
 #include <atomic>
 #include <memory>
 #include <memory_resource>
 #include <mutex>
 #include <pthread.h>
-#include <random>
 #include <thread>
 #include <vector>
-#include <unordered_map>
-#include <condition_variable>
 #include <chrono>
 
 namespace swiftnet
@@ -20,39 +20,7 @@ namespace swiftnet
     // Forward declarations
     class event_loop;
     class io_context;
-
-    // Suspension reasons for virtual threads
-    enum class SuspendReason {
-        NONE,
-        IO_WAIT,
-        YIELD,
-        COMPLETED,
-        PREEMPTED
-    };
-
-    // I/O operation details
-    struct IOOperation {
-        int fd;
-        uint32_t events;
-        std::coroutine_handle<> handle;
-        std::chrono::steady_clock::time_point start_time;
-        
-        IOOperation(int f, uint32_t e, std::coroutine_handle<> h)
-            : fd(f), events(e), handle(h), start_time(std::chrono::steady_clock::now()) {}
-    };
-
-    // Virtual thread execution context
-    struct VThreadContext {
-        std::coroutine_handle<> handle;
-        SuspendReason suspend_reason{SuspendReason::NONE};
-        std::chrono::steady_clock::time_point last_resume;
-        uint64_t cpu_time_us{0};
-        uint32_t core_affinity{0};
-        bool is_mounted{false};
-        
-        VThreadContext(std::coroutine_handle<> h) 
-            : handle(h), last_resume(std::chrono::steady_clock::now()) {}
-    };
+    class io_awaitable;
 
     class vthread_scheduler
     {
@@ -68,9 +36,23 @@ namespace swiftnet
         void yield_current(std::coroutine_handle<> h);
         
         // I/O suspension/resumption
-        void suspend_for_io(std::coroutine_handle<> h, int fd, uint32_t events);
+        bool suspend_for_io(std::coroutine_handle<> h, io_awaitable *op, int fd, uint32_t events);
+        void suspend_for_completion(std::coroutine_handle<> h);
         void resume_from_io(std::coroutine_handle<> h, int result);
-        void cancel_io_operation(std::coroutine_handle<> h);
+        void release_fd(int fd);
+        // Registers fd with core's reactor now, so its readiness (and the
+        // frames waiting on it) always come back to that core; otherwise
+        // the core that first waits on it owns it
+        bool bind_fd(int fd, std::size_t core);
+        
+        // Timers on the calling core's wheel. suspend_for_timer parks h until
+        // the deadline (worker threads only); arm_timer just fires t->fire.
+        bool suspend_for_timer(std::coroutine_handle<> h, detail::timer_node *t, std::chrono::steady_clock::time_point deadline);
+        bool arm_timer(detail::timer_node *t, std::chrono::steady_clock::time_point deadline);
+        void cancel_timer(detail::timer_node *t);
+        
+        std::size_t current_core() const noexcept;
+        std::size_t core_count() const noexcept { return ncores_; }
         
         // Virtual thread lifecycle
         void mount_vthread(std::coroutine_handle<> h, std::size_t core);
@@ -82,7 +64,7 @@ namespace swiftnet
         void complete_pending(std::coroutine_handle<> h);
         void notify_completion(std::coroutine_handle<> h) noexcept;
 
-        // Resource management
+        // Resource management: the core's arena, usable from that core's worker only
         std::pmr::memory_resource *local_resource(std::size_t core);
         
         // Statistics and monitoring
@@ -93,7 +75,26 @@ namespace swiftnet
             uint64_t work_stolen{0};
             uint64_t context_switches{0};
             std::vector<uint64_t> per_core_executed;
+            
+            // Scheduler health
+            uint64_t steal_attempts{0};
+            double steal_success_rate{0.0}; // steals that got work / attempts
+            uint64_t avg_run_queue_wait_ns{0}; // enqueue to mount, per resume
+            uint64_t avg_mounted_ns{0};        // time on a core, per resume
+
+            // The counters above for each core, plus its run-queue depth
+            struct CoreStats {
+                uint64_t executed{0};
+                uint64_t io_suspended{0};
+                uint64_t steal_attempts{0};
+                uint64_t steals{0};     // attempts that got work
+                uint64_t stolen{0};     // tasks those took
+                uint64_t run_queue{0};  // tasks in its deque now (inbox not included)
+            };
+            std::vector<CoreStats> per_core;
         };
+
+        // Sums the per-core counters; cheap enough to poll, but not free
         Stats get_stats() const;
 
     private:
@@ -104,58 +105,70 @@ namespace swiftnet
         void worker(std::size_t core_id);
         void bind_core(std::size_t core);
         bool try_steal_work(std::size_t core);
+        void run_task(vthread task, std::size_t core);
+        void enqueue(vthread t, std::size_t core);
+        std::size_t drain_inbox(std::size_t core);
         void wake_worker(std::size_t core);
+        void wake_idle_sibling(std::size_t core);
         void sleep_worker(std::size_t core);
 
         // I/O event handling
-        void process_io_completions();
-        void cleanup_expired_io_operations();
+        void poll_io(std::size_t core, int timeout_ms);
+        void wake_io_waiter(std::atomic<std::uintptr_t> &slot, int result);
+        bool register_fd(detail::fd_state &st, int fd, std::size_t core);
         
         // Internal scheduling helpers
         std::size_t select_best_core() const;
-        void balance_load();
         bool should_preempt_vthread(const VThreadContext& ctx) const;
 
-        using queue_t = detail::mpsc_queue<vthread>;
+        // Queued frames are held as raw handles; whoever dequeues one owns it
+        using task_t = vthread::handle_type;
+        using deque_t = detail::ws_deque<task_t>;
+        using inbox_t = detail::mpsc_queue<task_t>;
         
         // Core data structures
-        std::vector<queue_t> queues_;
-        std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> arenas_;
+        std::vector<std::unique_ptr<deque_t>> deques_; // owner push/pop, other cores steal
+        std::vector<inbox_t> inboxes_;                 // submissions from other threads
         std::vector<std::thread> workers_;
         
-        // I/O suspension management
-        std::unordered_map<std::coroutine_handle<>, IOOperation> io_operations_;
-        std::mutex io_operations_mutex_;
+        // Per-core readiness reactors and the descriptor state they share
+        std::vector<std::unique_ptr<event_loop>> event_loops_;
+        std::vector<int> ring_event_fds_; // io_uring completion eventfd per core, -1 if none
+        detail::fd_table fds_;
+        std::vector<std::unique_ptr<detail::timer_wheel>> timers_; // advanced by the owning worker only
         
-        // Worker thread synchronization
-        std::vector<std::unique_ptr<std::condition_variable>> worker_conditions_;
-        std::vector<std::unique_ptr<std::mutex>> worker_mutexes_;
-        std::vector<bool> worker_sleeping_;
-        
-        // Virtual thread context tracking
-        std::unordered_map<std::coroutine_handle<>, VThreadContext> vthread_contexts_;
-        std::mutex contexts_mutex_;
+        // Worker thread synchronization (a sleeping worker blocks in its reactor)
+        std::vector<std::unique_ptr<std::atomic<bool>>> worker_sleeping_;
         
         // Load balancing
         std::atomic<std::size_t> next_core_{0};
-        std::vector<std::unique_ptr<std::atomic<uint32_t>>> core_loads_;
-        std::chrono::steady_clock::time_point last_balance_time_;
+        std::vector<std::unique_ptr<std::atomic<uint32_t>>> core_loads_; // frames queued or running, per core
         
         // State management
         std::atomic<bool> running_{false};
         std::size_t ncores_{0};
         std::mutex global_mutex_;
         
-        // Statistics
-        mutable Stats stats_;
-        mutable std::mutex stats_mutex_;
-        
-        // Timers and cleanup
-        std::thread cleanup_thread_;
-        std::atomic<bool> cleanup_running_{false};
+        // Statistics, one padded block per core so workers never share a
+        // line. Counters only grow and are bumped with relaxed atomics;
+        // get_stats() sums them on demand.
+        struct alignas(64) core_stats
+        {
+            std::atomic<uint64_t> scheduled{0};
+            std::atomic<uint64_t> io_suspended{0};
+            std::atomic<uint64_t> resumed{0};
+            std::atomic<uint64_t> executed{0};
+            std::atomic<uint64_t> context_switches{0};
+            std::atomic<uint64_t> steal_attempts{0};
+            std::atomic<uint64_t> steals{0};
+            std::atomic<uint64_t> stolen{0};
+            std::atomic<uint64_t> queue_wait_ns{0};
+            std::atomic<uint64_t> mounted_ns{0};
+        };
+        std::vector<std::unique_ptr<core_stats>> core_stats_;
+        core_stats &stats_for(std::size_t core) noexcept;
         
-        // Integration with event loop
-        std::unique_ptr<event_loop> event_loop_;
+        // Integration with the completion-based backend
         std::shared_ptr<io_context> io_context_;
     };
 
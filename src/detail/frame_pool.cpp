@@ -0,0 +1,160 @@
+#include "detail/frame_pool.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <new>
+
+namespace swiftnet::detail
+{
+    namespace
+    {
+        constexpr std::size_t min_class_shift = 6; // 64 bytes
+        constexpr std::size_t num_classes = 7;     // 64 B .. 4 KiB
+        constexpr std::size_t max_class_size = std::size_t{1} << (min_class_shift + num_classes - 1);
+        constexpr std::uint32_t heap_block = 0xffffffffu;
+
+        // Prepended to every block; keeps the frame at max_align_t alignment
+        struct alignas(alignof(std::max_align_t)) block_header
+        {
+            std::uint32_t core;
+            std::uint32_t cls;
+        };
+        constexpr std::size_t header_size = sizeof(block_header);
+
+        struct free_node
+        {
+            free_node *next;
+        };
+
+        struct alignas(64) core_cache
+        {
+            free_node *local[num_classes]{}; // owner only
+
+            alignas(64) std::atomic<free_node *> remote[num_classes]{};
+
+            std::pmr::monotonic_buffer_resource arena{1024 * 1024}; // 1 MiB first chunk
+        };
+
+        std::array<std::atomic<core_cache *>, frame_pool::max_cores> caches{};
+
+        thread_local core_cache *tls_cache = nullptr;
+        thread_local std::uint32_t tls_core = heap_block;
+
+        core_cache *cache_for(std::size_t core)
+        {
+            core_cache *c = caches[core].load(std::memory_order_acquire);
+            if (!c)
+            {
+                auto *fresh = new core_cache();
+                if (caches[core].compare_exchange_strong(c, fresh, std::memory_order_acq_rel))
+                    c = fresh;
+                else
+                    delete fresh;
+            }
+            return c;
+        }
+
+        inline std::size_t class_of(std::size_t total) noexcept
+        {
+            std::size_t shift = std::bit_width(total - 1);
+            return shift <= min_class_shift ? 0 : shift - min_class_shift;
+        }
+
+        inline block_header *header_of(void *p) noexcept
+        {
+            return reinterpret_cast<block_header *>(static_cast<char *>(p) - header_size);
+        }
+    }
+
+    void *frame_pool::allocate(std::size_t size)
+    {
+        std::size_t total = size + header_size;
+        core_cache *cache = tls_cache;
+
+        if (!cache || total > max_class_size)
+        {
+            auto *h = static_cast<block_header *>(::operator new(total));
+            h->core = heap_block;
+            h->cls = heap_block;
+            return h + 1;
+        }
+
+        std::size_t cls = class_of(total);
+        free_node *n = cache->local[cls];
+        if (!n)
+        {
+            // Take back everything other cores freed for this class
+            n = cache->remote[cls].exchange(nullptr, std::memory_order_acquire);
+        }
+
+        block_header *h;
+        if (n)
+        {
+            cache->local[cls] = n->next;
+            h = reinterpret_cast<block_header *>(n);
+        }
+        else
+        {
+            h = static_cast<block_header *>(cache->arena.allocate(std::size_t{1} << (cls + min_class_shift), alignof(block_header)));
+        }
+        h->core = tls_core;
+        h->cls = static_cast<std::uint32_t>(cls);
+        return h + 1;
+    }
+
+    void frame_pool::deallocate(void *p) noexcept
+    {
+        if (!p)
+            return;
+
+        block_header *h = header_of(p);
+        if (h->core == heap_block)
+        {
+            ::operator delete(h);
+            return;
+        }
+
+        std::uint32_t cls = h->cls;
+        auto *n = reinterpret_cast<free_node *>(h);
+        if (h->core == tls_core)
+        {
+            n->next = tls_cache->local[cls];
+            tls_cache->local[cls] = n;
+            return;
+        }
+
+        // Cross-core free: Treiber push onto the owner's remote list. The
+        // owner only ever takes the whole list, so there is no ABA window.
+        core_cache *owner = caches[h->core].load(std::memory_order_acquire);
+        free_node *head = owner->remote[cls].load(std::memory_order_relaxed);
+        do
+        {
+            n->next = head;
+        } while (!owner->remote[cls].compare_exchange_weak(head, n, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void frame_pool::bind_thread(std::size_t core)
+    {
+        if (core >= max_cores)
+        {
+            unbind_thread();
+            return;
+        }
+        tls_cache = cache_for(core);
+        tls_core = static_cast<std::uint32_t>(core);
+    }
+
+    void frame_pool::unbind_thread() noexcept
+    {
+        tls_cache = nullptr;
+        tls_core = heap_block;
+    }
+
+    std::pmr::memory_resource *frame_pool::arena(std::size_t core)
+    {
+        if (core >= max_cores)
+            return std::pmr::get_default_resource();
+        return &cache_for(core)->arena;
+    }
+}
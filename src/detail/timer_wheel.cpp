@@ -0,0 +1,178 @@
+#include "detail/timer_wheel.hpp"
+
+namespace swiftnet::detail
+{
+    namespace
+    {
+        constexpr std::uint64_t slot_mask = timer_wheel::slots - 1;
+
+        // Ticks covered by levels [0, level]
+        constexpr std::uint64_t span(std::size_t level) noexcept
+        {
+            return std::uint64_t{1} << (timer_wheel::slot_bits * (level + 1));
+        }
+    }
+
+    timer_wheel::timer_wheel() : current_(now_tick())
+    {
+        for (auto &level : heads_)
+        {
+            for (auto &head : level)
+                head.prev = head.next = &head;
+        }
+    }
+
+    std::uint64_t timer_wheel::to_tick(clock::time_point tp) noexcept
+    {
+        return static_cast<std::uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(tp.time_since_epoch()).count());
+    }
+
+    std::uint64_t timer_wheel::now_tick() noexcept
+    {
+        return static_cast<std::uint64_t>(std::chrono::floor<std::chrono::milliseconds>(clock::now().time_since_epoch()).count());
+    }
+
+    void timer_wheel::arm(timer_node *n, std::uint64_t expires)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (n->armed())
+        {
+            unlink(n);
+            --count_;
+        }
+        n->expires = expires;
+        n->wheel = this;
+        link(n);
+        ++count_;
+    }
+
+    bool timer_wheel::cancel(timer_node *n)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!n->armed())
+            return false;
+        unlink(n);
+        --count_;
+        return true;
+    }
+
+    void timer_wheel::advance(std::uint64_t now)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0)
+        {
+            // Nothing to walk past; just catch up
+            if (now >= current_)
+                current_ = now + 1;
+            return;
+        }
+
+        while (current_ <= now)
+        {
+            std::size_t idx = current_ & slot_mask;
+
+            // Entering a new level-0 round: pull the next slot of each higher
+            // level down, stopping at the first level that has not wrapped
+            if (idx == 0)
+            {
+                for (std::size_t level = 1; level < levels && cascade(level) == 0; ++level)
+                {
+                }
+            }
+
+            // Timers armed for this tick from here on land in the next one
+            ++current_;
+
+            timer_node *head = &heads_[0][idx];
+            while (head->next != head)
+            {
+                timer_node *n = head->next;
+                unlink(n);
+                --count_;
+                n->fire(n);
+            }
+
+            if (count_ == 0)
+            {
+                if (now >= current_)
+                    current_ = now + 1;
+                return;
+            }
+        }
+    }
+
+    int timer_wheel::next_timeout_ms(int cap)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0)
+            return cap;
+
+        std::uint64_t now = now_tick();
+        for (int i = 0; i < cap; ++i)
+        {
+            // Either a due slot or a cascade point that may refill level 0
+            std::uint64_t t = current_ + static_cast<std::uint64_t>(i);
+            timer_node *head = &heads_[0][t & slot_mask];
+            if (head->next != head || (t & slot_mask) == 0)
+                return t > now ? static_cast<int>(t - now) : 0;
+        }
+        return cap;
+    }
+
+    void timer_wheel::link(timer_node *n)
+    {
+        std::uint64_t expires = n->expires;
+        timer_node *head;
+
+        if (expires <= current_)
+        {
+            // Overdue: fire on the very next tick
+            head = &heads_[0][current_ & slot_mask];
+        }
+        else
+        {
+            std::uint64_t delta = expires - current_;
+            std::size_t level = 0;
+            while (level + 1 < levels && delta >= span(level))
+                ++level;
+
+            // Beyond the last level: park at its far end and re-file on cascade
+            if (delta >= span(levels - 1))
+                expires = current_ + span(levels - 1) - 1;
+
+            head = &heads_[level][(expires >> (slot_bits * level)) & slot_mask];
+        }
+
+        n->prev = head->prev;
+        n->next = head;
+        head->prev->next = n;
+        head->prev = n;
+    }
+
+    void timer_wheel::unlink(timer_node *n) noexcept
+    {
+        n->prev->next = n->next;
+        n->next->prev = n->prev;
+        n->prev = n->next = nullptr;
+    }
+
+    std::size_t timer_wheel::cascade(std::size_t level)
+    {
+        std::size_t idx = (current_ >> (slot_bits * level)) & slot_mask;
+        timer_node *head = &heads_[level][idx];
+
+        // Detach the whole slot first; re-filing may link into lower levels only
+        timer_node *n = head->next;
+        head->prev->next = nullptr;
+        head->prev = head->next = head;
+
+        while (n && n != head)
+        {
+            timer_node *next = n->next;
+            link(n);
+            n = next;
+        }
+        return idx;
+    }
+
+}
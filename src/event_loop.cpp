@@ -1,14 +1,13 @@
 #include "event_loop.hpp"
-#include <unordered_map>
 #include <stdexcept>
 #include <cstring>
 #include <vector>
 #include <errno.h>
 
-#if defined(SWIFTNET_BACKEND_IOURING)
-#include <fcntl.h>
-#include <poll.h>
-#include <liburing.h>
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
 #include <sys/event.h>
 #include <unistd.h>
@@ -25,23 +24,33 @@ using namespace swiftnet;
 namespace
 {
     /* translate swiftnet::event_mask into OS specific flags */
-#if defined(SWIFTNET_BACKEND_IOURING)
-    static unsigned to_poll_events(std::uint32_t mask)
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    static std::uint32_t to_epoll_events(std::uint32_t mask)
     {
-        unsigned ev = 0;
+        std::uint32_t ev = EPOLLET | EPOLLRDHUP;
         if (mask & READABLE)
-            ev |= POLLIN;
+            ev |= EPOLLIN;
         if (mask & WRITABLE)
-            ev |= POLLOUT;
+            ev |= EPOLLOUT;
         return ev;
     }
-#elif defined(SWIFTNET_BACKEND_KQUEUE)
-    static int to_kqueue_filter(std::uint32_t mask)
+
+    static std::uint32_t from_epoll_events(std::uint32_t ev)
     {
-        // not used – we register separate events for read / write.
-        (void)mask;
-        return 0;
+        std::uint32_t mask = 0;
+        if (ev & EPOLLIN)
+            mask |= READABLE;
+        if (ev & EPOLLOUT)
+            mask |= WRITABLE;
+        if (ev & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+            mask |= CLOSED;
+        return mask;
     }
+
+    // user_data tag of the wakeup eventfd; socket descriptors are never negative
+    constexpr std::uint64_t wake_tag = ~std::uint64_t{0};
+#elif defined(SWIFTNET_BACKEND_KQUEUE)
+    constexpr uintptr_t wake_ident = 0x5357; // EVFILT_USER identifier
 #endif
 } // namespace
 
@@ -51,14 +60,33 @@ namespace
 
 event_loop::event_loop()
 {
-#if defined(SWIFTNET_BACKEND_IOURING)
-    ring_ = new io_uring;
-    if (io_uring_queue_init(1024, ring_, IORING_SETUP_SINGLE_ISSUER) != 0)
-        throw std::runtime_error("io_uring_queue_init failed");
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd_ == -1)
+        throw std::runtime_error("epoll_create1 failed");
+    wakefd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakefd_ == -1)
+    {
+        close(epfd_);
+        throw std::runtime_error("eventfd failed");
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = wake_tag;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, wakefd_, &ev) == -1)
+    {
+        close(wakefd_);
+        close(epfd_);
+        throw std::runtime_error("epoll_ctl wakeup registration failed");
+    }
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
     kq_ = kqueue();
     if (kq_ == -1)
         throw std::runtime_error("kqueue() failed");
+    struct kevent ev;
+    EV_SET(&ev, wake_ident, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+    if (kevent(kq_, &ev, 1, nullptr, 0, nullptr) == -1)
+        throw std::runtime_error("kevent wakeup registration failed");
 #elif defined(SWIFTNET_BACKEND_IOCP)
     iocp_ = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 0);
     if (!iocp_)
@@ -68,9 +96,9 @@ event_loop::event_loop()
 
 event_loop::~event_loop()
 {
-#if defined(SWIFTNET_BACKEND_IOURING)
-    io_uring_queue_exit(ring_);
-    delete ring_;
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    close(wakefd_);
+    close(epfd_);
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
     close(kq_);
 #elif defined(SWIFTNET_BACKEND_IOCP)
@@ -82,38 +110,38 @@ event_loop::~event_loop()
  * Add / Mod / Del
  * ---------------------------------------------------------*/
 
-void event_loop::add(int fd, std::uint32_t mask)
+bool event_loop::add(int fd, std::uint32_t mask)
 {
-#if defined(SWIFTNET_BACKEND_IOURING)
-    auto sqe = io_uring_get_sqe(ring_);
-    io_uring_prep_poll_add(sqe, fd, to_poll_events(mask));
-    // store fd in user_data so we can map later
-    io_uring_sqe_set_data64(sqe, static_cast<std::uint64_t>(fd));
-    io_uring_submit(ring_);
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    epoll_event ev{};
+    ev.events = to_epoll_events(mask);
+    ev.data.u64 = static_cast<std::uint64_t>(fd);
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == 0)
+        return true;
+    return errno == EEXIST;
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
     struct kevent ev[2];
     int n = 0;
     if (mask & READABLE)
-        EV_SET(&ev[n++], fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+        EV_SET(&ev[n++], fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, nullptr);
     if (mask & WRITABLE)
-        EV_SET(&ev[n++], fd, EVFILT_WRITE, EV_ADD, 0, 0, nullptr);
-    if (kevent(kq_, ev, n, nullptr, 0, nullptr) == -1)
-        throw std::runtime_error("kevent add failed");
+        EV_SET(&ev[n++], fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+    return kevent(kq_, ev, n, nullptr, 0, nullptr) != -1;
 #elif defined(SWIFTNET_BACKEND_IOCP)
     // IOCP is completion based; user must have issued async I/O.
     // Associate socket/handle so we can poll completions.
-    if (!CreateIoCompletionPort(reinterpret_cast<HANDLE>(static_cast<intptr_t>(fd)), static_cast<HANDLE>(iocp_), static_cast<ULONG_PTR>(fd), 0))
-        throw std::runtime_error("CreateIoCompletionPort associate failed");
     (void)mask; // mask not used
+    return CreateIoCompletionPort(reinterpret_cast<HANDLE>(static_cast<intptr_t>(fd)), static_cast<HANDLE>(iocp_), static_cast<ULONG_PTR>(fd), 0) != nullptr;
 #endif
 }
 
 void event_loop::mod(int fd, std::uint32_t mask)
 {
-#if defined(SWIFTNET_BACKEND_IOURING)
-    // simply remove and re-add
-    del(fd);
-    add(fd, mask);
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    epoll_event ev{};
+    ev.events = to_epoll_events(mask);
+    ev.data.u64 = static_cast<std::uint64_t>(fd);
+    epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev);
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
     del(fd);
     add(fd, mask);
@@ -125,10 +153,8 @@ void event_loop::mod(int fd, std::uint32_t mask)
 
 void event_loop::del(int fd)
 {
-#if defined(SWIFTNET_BACKEND_IOURING)
-    auto sqe = io_uring_get_sqe(ring_);
-    io_uring_prep_poll_remove(sqe, static_cast<std::uint64_t>(fd));
-    io_uring_submit(ring_);
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
     struct kevent ev[2];
     EV_SET(&ev[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
@@ -140,41 +166,50 @@ void event_loop::del(int fd)
 #endif
 }
 
+void event_loop::notify()
+{
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto r = write(wakefd_, &one, sizeof(one));
+#elif defined(SWIFTNET_BACKEND_KQUEUE)
+    struct kevent ev;
+    EV_SET(&ev, wake_ident, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+    kevent(kq_, &ev, 1, nullptr, 0, nullptr);
+#elif defined(SWIFTNET_BACKEND_IOCP)
+    PostQueuedCompletionStatus(static_cast<HANDLE>(iocp_), 0, 0, nullptr);
+#endif
+}
+
 /* -----------------------------------------------------------
  * Wait
  * ---------------------------------------------------------*/
 
 int event_loop::wait(io_event *evs, int max, int timeout_ms)
 {
-#if defined(SWIFTNET_BACKEND_IOURING)
-    int cnt = 0;
-    struct __kernel_timespec ts;
-    ts.tv_sec = timeout_ms / 1000;
-    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
-
-    io_uring_cqe *cqe;
-    int ret = io_uring_wait_cqe_timeout(ring_, &cqe, &ts);
-    if (ret == -ETIME || ret == -EAGAIN)
-        return 0;
-    if (ret < 0)
-        throw std::runtime_error("io_uring_wait_cqe_timeout failed");
+#if defined(SWIFTNET_BACKEND_IOURING) || defined(SWIFTNET_BACKEND_EPOLL)
+    constexpr int batch = 128;
+    epoll_event events[batch];
+    int n = epoll_wait(epfd_, events, max < batch ? max : batch, timeout_ms);
+    if (n < 0)
+    {
+        if (errno == EINTR)
+            return 0;
+        throw std::runtime_error("epoll_wait failed");
+    }
 
-    /* iterate over completions up to max */
-    while (cqe && cnt < max)
+    int cnt = 0;
+    for (int i = 0; i < n; ++i)
     {
-        evs[cnt].fd = static_cast<int>(io_uring_cqe_get_data64(cqe));
-        evs[cnt].mask = 0;
-        if (cqe->res & POLLIN)
-            evs[cnt].mask |= READABLE;
-        if (cqe->res & POLLOUT)
-            evs[cnt].mask |= WRITABLE;
-        evs[cnt].res = cqe->res;
+        if (events[i].data.u64 == wake_tag)
+        {
+            std::uint64_t drained;
+            [[maybe_unused]] auto r = read(wakefd_, &drained, sizeof(drained));
+            continue;
+        }
+        evs[cnt].fd = static_cast<int>(events[i].data.u64);
+        evs[cnt].mask = from_epoll_events(events[i].events);
+        evs[cnt].res = 0;
         ++cnt;
-        io_uring_cqe_seen(ring_, cqe);
-        if (cnt < max)
-            io_uring_peek_cqe(ring_, &cqe);
-        else
-            break;
     }
     return cnt;
 #elif defined(SWIFTNET_BACKEND_KQUEUE)
@@ -184,18 +219,28 @@ int event_loop::wait(io_event *evs, int max, int timeout_ms)
     ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
     int n = kevent(kq_, nullptr, 0, events.data(), max, &ts);
     if (n == -1)
+    {
+        if (errno == EINTR)
+            return 0;
         throw std::runtime_error("kevent wait failed");
+    }
+    int cnt = 0;
     for (int i = 0; i < n; ++i)
     {
-        evs[i].fd = static_cast<int>(events[i].ident);
-        evs[i].mask = 0;
+        if (events[i].filter == EVFILT_USER)
+            continue;
+        evs[cnt].fd = static_cast<int>(events[i].ident);
+        evs[cnt].mask = 0;
         if (events[i].filter == EVFILT_READ)
-            evs[i].mask |= READABLE;
+            evs[cnt].mask |= READABLE;
         if (events[i].filter == EVFILT_WRITE)
-            evs[i].mask |= WRITABLE;
-        evs[i].res = static_cast<int>(events[i].data);
+            evs[cnt].mask |= WRITABLE;
+        if (events[i].flags & (EV_EOF | EV_ERROR))
+            evs[cnt].mask |= CLOSED;
+        evs[cnt].res = static_cast<int>(events[i].data);
+        ++cnt;
     }
-    return n;
+    return cnt;
 #elif defined(SWIFTNET_BACKEND_IOCP)
     DWORD bytes_transferred = 0;
     ULONG_PTR key = 0;
@@ -203,11 +248,14 @@ int event_loop::wait(io_event *evs, int max, int timeout_ms)
     BOOL ok = GetQueuedCompletionStatus(static_cast<HANDLE>(iocp_), &bytes_transferred, &key, &overlapped, timeout_ms);
     if (!ok && overlapped == nullptr)
         return 0; // timeout or error with no completion
+    if (ok && overlapped == nullptr)
+        return 0; // notify() wakeup
     if (!ok)
         throw std::runtime_error("GetQueuedCompletionStatus failed");
+    (void)max;
     evs[0].fd = static_cast<int>(key);
     evs[0].mask = READABLE | WRITABLE; // unknown – assume both
     evs[0].res = static_cast<int>(bytes_transferred);
     return 1;
 #endif
-} 
\ No newline at end of file
+}
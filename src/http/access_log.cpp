@@ -0,0 +1,202 @@
+#include "http/access_log.hpp"
+#include "log.hpp"
+#include "vthread_scheduler.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+using namespace swiftnet;
+using namespace swiftnet::http;
+
+namespace
+{
+    // Records moved out of a ring per write
+    constexpr std::size_t batch_records = 1024;
+
+    constexpr std::array<std::string_view, 10> method_names = {
+        "OTHER", "GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", "CONNECT", "TRACE"};
+}
+
+access_method swiftnet::http::method_code(std::string_view method) noexcept
+{
+    for (std::size_t i = 1; i < method_names.size(); ++i)
+    {
+        if (method == method_names[i])
+            return static_cast<access_method>(i);
+    }
+    return access_method::other;
+}
+
+std::string_view swiftnet::http::method_name(access_method m) noexcept
+{
+    auto i = static_cast<std::size_t>(m);
+    return i < method_names.size() ? method_names[i] : method_names[0];
+}
+
+access_log::access_log(options opts, std::vector<std::string> routes, std::size_t cores)
+    : opts_(std::move(opts)), routes_(std::move(routes))
+{
+    opts_.max_files = std::max<std::size_t>(1, opts_.max_files);
+    for (std::size_t i = 0; i <= cores; ++i)
+        rings_.push_back(std::make_unique<ring>(opts_.ring_records));
+
+    // A file left by an earlier run has its own route table; keep it whole
+    std::error_code ec;
+    if (auto size = std::filesystem::file_size(opts_.path, ec); !ec && size > 0)
+        rotate();
+    if (!open_file())
+        throw std::runtime_error("Cannot open access log " + opts_.path + ": " + std::strerror(errno));
+
+    flusher_ = std::thread([this] { run(); });
+}
+
+access_log::~access_log()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    flusher_.join();
+    if (file_)
+        std::fclose(file_);
+}
+
+void access_log::record(const access_record &r) noexcept
+{
+    std::size_t core = vthread_scheduler::instance().current_core();
+    bool pushed;
+    if (core < rings_.size() - 1)
+    {
+        // Only this core's worker pushes here
+        pushed = rings_[core]->push(r);
+    }
+    else
+    {
+        std::lock_guard lock(shared_mutex_);
+        pushed = rings_.back()->push(r);
+    }
+    if (!pushed)
+        dropped_total_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void access_log::run()
+{
+    std::unique_lock lock(mutex_);
+    while (!stopping_)
+    {
+        wake_.wait_for(lock, opts_.flush_interval);
+        drain();
+    }
+    // Workers have stopped by the time the log is destroyed
+    drain();
+}
+
+void access_log::drain()
+{
+    std::array<access_record, batch_records> batch;
+    bool wrote = false;
+    for (auto &r : rings_)
+    {
+        while (std::size_t n = r->pop(batch.data(), batch.size()))
+        {
+            write(batch.data(), n);
+            wrote = true;
+        }
+    }
+    if (wrote && file_)
+        std::fflush(file_);
+
+    std::uint64_t dropped = dropped_total_.load(std::memory_order_relaxed);
+    if (dropped != dropped_reported_)
+    {
+        SWIFTNET_LOG_WARN("Access log dropped {} records (rings full)", dropped - dropped_reported_);
+        dropped_reported_ = dropped;
+    }
+}
+
+void access_log::write(const access_record *records, std::size_t n)
+{
+    std::size_t bytes = n * sizeof(access_record);
+    // Rotate between records, and never leave a file holding only a header
+    if (file_ && file_bytes_ + bytes > opts_.max_file_bytes && file_bytes_ > header_bytes_)
+    {
+        std::size_t room = file_bytes_ < opts_.max_file_bytes
+                               ? (opts_.max_file_bytes - file_bytes_) / sizeof(access_record)
+                               : 0;
+        if (room > 0)
+        {
+            write(records, room);
+            records += room;
+            n -= room;
+        }
+        std::fclose(file_);
+        file_ = nullptr;
+        rotate();
+        if (!open_file())
+            SWIFTNET_LOG_ERROR("Cannot reopen access log {}: {}", opts_.path, std::strerror(errno));
+        write(records, n);
+        return;
+    }
+
+    if (!file_ && !open_file())
+    {
+        dropped_total_.fetch_add(n, std::memory_order_relaxed);
+        return;
+    }
+    std::size_t written = std::fwrite(records, sizeof(access_record), n, file_);
+    file_bytes_ += written * sizeof(access_record);
+    if (written < n)
+    {
+        SWIFTNET_LOG_ERROR("Access log write to {} failed: {}", opts_.path, std::strerror(errno));
+        dropped_total_.fetch_add(n - written, std::memory_order_relaxed);
+    }
+}
+
+bool access_log::open_file()
+{
+    file_ = std::fopen(opts_.path.c_str(), "wb");
+    file_bytes_ = header_bytes_ = 0;
+    if (!file_)
+        return false;
+
+    access_log_header h{};
+    std::memcpy(h.magic, access_log_magic, sizeof(h.magic));
+    h.version = access_log_version;
+    h.record_size = sizeof(access_record);
+    h.routes = static_cast<std::uint32_t>(routes_.size());
+    std::fwrite(&h, sizeof(h), 1, file_);
+    file_bytes_ = sizeof(h);
+
+    for (const auto &route : routes_)
+    {
+        auto length = static_cast<std::uint16_t>(std::min<std::size_t>(route.size(), 0xffff));
+        std::fwrite(&length, sizeof(length), 1, file_);
+        std::fwrite(route.data(), 1, length, file_);
+        file_bytes_ += sizeof(length) + length;
+    }
+    header_bytes_ = file_bytes_;
+    std::fflush(file_);
+    return true;
+}
+
+void access_log::rotate()
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    auto numbered = [this](std::size_t i) { return opts_.path + "." + std::to_string(i); };
+
+    if (opts_.max_files == 1)
+    {
+        fs::remove(opts_.path, ec);
+        return;
+    }
+    fs::remove(numbered(opts_.max_files - 1), ec);
+    for (std::size_t i = opts_.max_files - 2; i >= 1; --i)
+        fs::rename(numbered(i), numbered(i + 1), ec); // missing ones are skipped
+    fs::rename(opts_.path, numbered(1), ec);
+}
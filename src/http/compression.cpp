@@ -0,0 +1,252 @@
+#include "http/compression.hpp"
+#include "http/headers.hpp"
+#include <array>
+#include <cstdint>
+
+#ifdef SWIFTNET_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SWIFTNET_HAS_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef SWIFTNET_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace swiftnet::http;
+
+namespace
+{
+    // Levels for bodies compressed per response: well past the knee of
+    // ratio against CPU for each format, far short of their maximums
+    constexpr int gzip_level = 5;
+    constexpr int brotli_quality = 5;
+    constexpr int zstd_level = 3;
+
+    std::string_view trim(std::string_view v) noexcept
+    {
+        while (!v.empty() && (v.front() == ' ' || v.front() == '\t'))
+            v.remove_prefix(1);
+        while (!v.empty() && (v.back() == ' ' || v.back() == '\t'))
+            v.remove_suffix(1);
+        return v;
+    }
+
+    // qvalue (RFC 9110 section 12.4.2) in thousandths; -1 if malformed
+    int parse_qvalue(std::string_view v) noexcept
+    {
+        if (v.empty() || (v[0] != '0' && v[0] != '1'))
+            return -1;
+        int q = (v[0] - '0') * 1000;
+        if (v.size() == 1)
+            return q;
+        if (v[1] != '.' || v.size() > 5)
+            return -1;
+        int scale = 100;
+        for (char c : v.substr(2))
+        {
+            if (c < '0' || c > '9')
+                return -1;
+            q += (c - '0') * scale;
+            scale /= 10;
+        }
+        return q > 1000 ? -1 : q;
+    }
+
+    bool starts_with(std::string_view s, std::string_view prefix) noexcept
+    {
+        return s.size() >= prefix.size() && iequals(s.substr(0, prefix.size()), prefix);
+    }
+
+    bool ends_with(std::string_view s, std::string_view suffix) noexcept
+    {
+        return s.size() >= suffix.size() && iequals(s.substr(s.size() - suffix.size()), suffix);
+    }
+
+#ifdef SWIFTNET_HAS_ZLIB
+    // One deflate stream per thread, reset rather than rebuilt per body
+    struct gzip_encoder
+    {
+        z_stream stream{};
+        bool ready{false};
+
+        gzip_encoder()
+        {
+            // windowBits 15 + 16 selects the gzip wrapper
+            ready = deflateInit2(&stream, gzip_level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        }
+
+        ~gzip_encoder()
+        {
+            if (ready)
+                deflateEnd(&stream);
+        }
+
+        bool compress(std::string_view in, std::string &out)
+        {
+            if (!ready || deflateReset(&stream) != Z_OK)
+                return false;
+            out.resize(deflateBound(&stream, static_cast<uLong>(in.size())));
+            stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+            stream.avail_in = static_cast<uInt>(in.size());
+            stream.next_out = reinterpret_cast<Bytef *>(out.data());
+            stream.avail_out = static_cast<uInt>(out.size());
+            if (deflate(&stream, Z_FINISH) != Z_STREAM_END)
+                return false;
+            out.resize(stream.total_out);
+            return true;
+        }
+    };
+#endif
+
+#ifdef SWIFTNET_HAS_ZSTD
+    struct zstd_encoder
+    {
+        ZSTD_CCtx *cctx{ZSTD_createCCtx()};
+
+        ~zstd_encoder() { ZSTD_freeCCtx(cctx); }
+
+        bool compress(std::string_view in, std::string &out)
+        {
+            if (!cctx)
+                return false;
+            out.resize(ZSTD_compressBound(in.size()));
+            std::size_t n = ZSTD_compressCCtx(cctx, out.data(), out.size(), in.data(), in.size(), zstd_level);
+            if (ZSTD_isError(n))
+                return false;
+            out.resize(n);
+            return true;
+        }
+    };
+#endif
+}
+
+std::string_view swiftnet::http::coding_name(content_coding c) noexcept
+{
+    switch (c)
+    {
+    case content_coding::gzip: return "gzip";
+    case content_coding::br: return "br";
+    case content_coding::zstd: return "zstd";
+    default: return {};
+    }
+}
+
+unsigned swiftnet::http::supported_codings() noexcept
+{
+    unsigned mask = 0;
+#ifdef SWIFTNET_HAS_ZLIB
+    mask |= coding_bit(content_coding::gzip);
+#endif
+#ifdef SWIFTNET_HAS_BROTLI
+    mask |= coding_bit(content_coding::br);
+#endif
+#ifdef SWIFTNET_HAS_ZSTD
+    mask |= coding_bit(content_coding::zstd);
+#endif
+    return mask;
+}
+
+content_coding swiftnet::http::negotiate_coding(std::string_view accept_encoding, unsigned offered) noexcept
+{
+    // In order of preference on equal q-values
+    constexpr std::array<content_coding, 3> codings = {content_coding::br, content_coding::zstd, content_coding::gzip};
+    std::array<int, 3> q = {-1, -1, -1}; // -1: not listed
+    int any = -1;
+
+    while (!accept_encoding.empty())
+    {
+        std::size_t comma = accept_encoding.find(',');
+        std::string_view item = accept_encoding.substr(0, comma);
+        accept_encoding.remove_prefix(comma == std::string_view::npos ? accept_encoding.size() : comma + 1);
+
+        std::size_t semi = item.find(';');
+        std::string_view name = trim(item.substr(0, semi));
+        int weight = 1000;
+        while (semi != std::string_view::npos)
+        {
+            item.remove_prefix(semi + 1);
+            semi = item.find(';');
+            std::string_view param = trim(item.substr(0, semi));
+            if (param.size() >= 2 && (param[0] | 0x20) == 'q' && param[1] == '=')
+                weight = parse_qvalue(param.substr(2));
+        }
+        if (name.empty() || weight < 0)
+            continue;
+
+        if (name == "*")
+        {
+            any = weight;
+            continue;
+        }
+        for (std::size_t i = 0; i < codings.size(); ++i)
+        {
+            if (iequals(name, coding_name(codings[i])) || (codings[i] == content_coding::gzip && iequals(name, "x-gzip")))
+                q[i] = weight;
+        }
+    }
+
+    content_coding best = content_coding::identity;
+    int best_q = 0;
+    for (std::size_t i = 0; i < codings.size(); ++i)
+    {
+        int w = q[i] >= 0 ? q[i] : any;
+        if ((offered & coding_bit(codings[i])) && w > best_q)
+        {
+            best = codings[i];
+            best_q = w;
+        }
+    }
+    return best;
+}
+
+bool swiftnet::http::compressible_type(std::string_view content_type) noexcept
+{
+    std::string_view type = trim(content_type.substr(0, content_type.find(';')));
+    if (starts_with(type, "text/"))
+        return true;
+    if (ends_with(type, "+json") || ends_with(type, "+xml"))
+        return true; // image/svg+xml among them
+    return iequals(type, "application/json") || iequals(type, "application/javascript") ||
+           iequals(type, "application/xml") || iequals(type, "application/wasm") ||
+           iequals(type, "application/x-tar") || iequals(type, "image/x-icon");
+}
+
+bool swiftnet::http::compress(content_coding c, std::string_view in, std::string &out)
+{
+    switch (c)
+    {
+#ifdef SWIFTNET_HAS_ZLIB
+    case content_coding::gzip:
+    {
+        thread_local gzip_encoder encoder;
+        return encoder.compress(in, out);
+    }
+#endif
+#ifdef SWIFTNET_HAS_BROTLI
+    case content_coding::br:
+    {
+        // The brotli encoder has no reset, so its one-shot entry point is
+        // used; it sizes its state to the input, which keeps that cheap
+        out.resize(BrotliEncoderMaxCompressedSize(in.size()));
+        std::size_t n = out.size();
+        if (out.empty() ||
+            !BrotliEncoderCompress(brotli_quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, in.size(),
+                                   reinterpret_cast<const std::uint8_t *>(in.data()), &n,
+                                   reinterpret_cast<std::uint8_t *>(out.data())))
+            return false;
+        out.resize(n);
+        return true;
+    }
+#endif
+#ifdef SWIFTNET_HAS_ZSTD
+    case content_coding::zstd:
+    {
+        thread_local zstd_encoder encoder;
+        return encoder.compress(in, out);
+    }
+#endif
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,121 @@
+#include "http/file_cache.hpp"
+#include "http/headers.hpp"
+#include <algorithm>
+
+using namespace swiftnet::http;
+
+std::shared_ptr<const cached_file> cached_file::load(const std::string &path,
+                                                     const std::function<std::string(const std::string &)> &mime_of,
+                                                     bool precompressed)
+{
+    auto f = open_file::open(path);
+    if (!f)
+        return nullptr;
+
+    auto c = std::make_shared<cached_file>();
+    c->etag = strong_etag(f->identity());
+    c->mtime = static_cast<std::time_t>(f->identity().mtime_ns / 1000000000);
+    c->last_modified = http_date(c->mtime);
+    c->mime_type = mime_of(path);
+
+    if (precompressed)
+    {
+        constexpr std::pair<std::string_view, content_coding> siblings[] = {
+            {".br", content_coding::br},
+            {".gz", content_coding::gzip},
+        };
+        for (const auto &[suffix, coding] : siblings)
+        {
+            // A sibling older than the file was made from a previous version
+            auto s = open_file::open(path + std::string(suffix));
+            if (!s || s->identity().mtime_ns < f->identity().mtime_ns)
+                continue;
+            auto e = std::make_shared<cached_file>();
+            e->etag = strong_etag(s->identity());
+            e->mtime = static_cast<std::time_t>(s->identity().mtime_ns / 1000000000);
+            e->last_modified = http_date(e->mtime);
+            e->mime_type = c->mime_type;
+            e->coding = coding;
+            e->file = std::move(s);
+            c->encoded.push_back(std::move(e));
+        }
+    }
+
+    c->file = std::move(f);
+    return c;
+}
+
+file_cache::file_cache(mime_resolver mime_of, std::size_t max_entries, std::chrono::milliseconds ttl)
+    : mime_of_(std::move(mime_of)),
+      shard_capacity_(std::max<std::size_t>(1, max_entries / shard_count)),
+      ttl_(ttl)
+{
+}
+
+std::shared_ptr<const cached_file> file_cache::get(const std::string &path)
+{
+    shard &s = shards_[std::hash<std::string>{}(path) % shard_count];
+    auto now = clock::now();
+    std::shared_ptr<const cached_file> stale;
+
+    {
+        std::lock_guard lock(s.mutex);
+        auto it = s.index.find(path);
+        if (it != s.index.end())
+        {
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+            if (now - it->second->checked < ttl_)
+                return it->second->file;
+            stale = it->second->file;
+        }
+    }
+
+    // Syscalls happen outside the lock; a racing revalidation of the same
+    // path just does the work twice
+    if (stale)
+    {
+        file_identity id;
+        if (open_file::stat(path, id) && id == stale->file->identity())
+        {
+            store(s, path, stale, now);
+            return stale;
+        }
+    }
+
+    auto fresh = cached_file::load(path, mime_of_, true);
+    if (fresh)
+    {
+        store(s, path, fresh, now);
+    }
+    else if (stale)
+    {
+        std::lock_guard lock(s.mutex);
+        auto it = s.index.find(path);
+        if (it != s.index.end())
+        {
+            s.lru.erase(it->second);
+            s.index.erase(it);
+        }
+    }
+    return fresh;
+}
+
+void file_cache::store(shard &s, const std::string &path, std::shared_ptr<const cached_file> file, clock::time_point now)
+{
+    std::lock_guard lock(s.mutex);
+    auto it = s.index.find(path);
+    if (it != s.index.end())
+    {
+        it->second->file = std::move(file);
+        it->second->checked = now;
+        return;
+    }
+
+    if (s.index.size() >= shard_capacity_)
+    {
+        s.index.erase(s.lru.back().path);
+        s.lru.pop_back();
+    }
+    s.lru.push_front({path, std::move(file), now});
+    s.index.emplace(path, s.lru.begin());
+}
@@ -0,0 +1,366 @@
+#include "http/headers.hpp"
+#include "detail/os_backend.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+using namespace swiftnet::http;
+
+namespace
+{
+    constexpr int first_status = 100;
+    constexpr int last_status = 599;
+
+    std::string_view reason_of(int status) noexcept
+    {
+        switch (status)
+        {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 102: return "Processing";
+        case 103: return "Early Hints";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 203: return "Non-Authoritative Information";
+        case 204: return "No Content";
+        case 205: return "Reset Content";
+        case 206: return "Partial Content";
+        case 207: return "Multi-Status";
+        case 208: return "Already Reported";
+        case 226: return "IM Used";
+        case 300: return "Multiple Choices";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 305: return "Use Proxy";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 402: return "Payment Required";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 406: return "Not Acceptable";
+        case 407: return "Proxy Authentication Required";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 410: return "Gone";
+        case 411: return "Length Required";
+        case 412: return "Precondition Failed";
+        case 413: return "Content Too Large";
+        case 414: return "URI Too Long";
+        case 415: return "Unsupported Media Type";
+        case 416: return "Range Not Satisfiable";
+        case 417: return "Expectation Failed";
+        case 421: return "Misdirected Request";
+        case 422: return "Unprocessable Content";
+        case 423: return "Locked";
+        case 424: return "Failed Dependency";
+        case 425: return "Too Early";
+        case 426: return "Upgrade Required";
+        case 428: return "Precondition Required";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 451: return "Unavailable For Legal Reasons";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        case 505: return "HTTP Version Not Supported";
+        case 506: return "Variant Also Negotiates";
+        case 507: return "Insufficient Storage";
+        case 508: return "Loop Detected";
+        case 510: return "Not Extended";
+        case 511: return "Network Authentication Required";
+        default: return {};
+        }
+    }
+
+    const auto status_lines = [] {
+        std::array<std::string, last_status - first_status + 1> lines;
+        for (int status = first_status; status <= last_status; ++status)
+        {
+            auto &line = lines[status - first_status];
+            line = "HTTP/1.1 " + std::to_string(status) + " ";
+            line += reason_of(status);
+            line += "\r\n";
+        }
+        return lines;
+    }();
+
+    struct date_cache
+    {
+        std::time_t second{-1};
+        std::array<char, 40> text{};
+    };
+
+    thread_local date_cache tls_date;
+
+    constexpr char day_names[] = "SunMonTueWedThuFriSat";
+    constexpr char month_names[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    void put2(char *p, int v) noexcept
+    {
+        p[0] = static_cast<char>('0' + v / 10);
+        p[1] = static_cast<char>('0' + v % 10);
+    }
+
+    // IMF-fixdate (RFC 9110 section 5.6.7), without strftime's locale
+    // lookups; writes imf_date_size bytes
+    constexpr std::size_t imf_date_size = 29;
+
+    void format_imf_date(std::time_t t, char *p) noexcept
+    {
+        std::tm tm{};
+#ifdef SWIFTNET_PLATFORM_WINDOWS
+        gmtime_s(&tm, &t);
+#else
+        gmtime_r(&t, &tm);
+#endif
+        // "Sun, 06 Nov 1994 08:49:37 GMT"
+        for (int i = 0; i < 3; ++i)
+            *p++ = day_names[tm.tm_wday * 3 + i];
+        *p++ = ',';
+        *p++ = ' ';
+        put2(p, tm.tm_mday);
+        p += 2;
+        *p++ = ' ';
+        for (int i = 0; i < 3; ++i)
+            *p++ = month_names[tm.tm_mon * 3 + i];
+        *p++ = ' ';
+        int year = tm.tm_year + 1900;
+        put2(p, year / 100);
+        put2(p + 2, year % 100);
+        p += 4;
+        *p++ = ' ';
+        put2(p, tm.tm_hour);
+        p[2] = ':';
+        put2(p + 3, tm.tm_min);
+        p[5] = ':';
+        put2(p + 6, tm.tm_sec);
+        p += 8;
+        for (char c : std::string_view(" GMT"))
+            *p++ = c;
+    }
+
+    bool digits(std::string_view s, std::size_t pos, std::size_t n, int &out) noexcept
+    {
+        out = 0;
+        for (std::size_t i = pos; i < pos + n; ++i)
+        {
+            if (s[i] < '0' || s[i] > '9')
+                return false;
+            out = out * 10 + (s[i] - '0');
+        }
+        return true;
+    }
+
+    // Days since 1970-01-01 of a proleptic Gregorian date
+    std::int64_t days_from_civil(int y, int m, int d) noexcept
+    {
+        y -= m <= 2;
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const int yoe = y - era * 400;
+        const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return static_cast<std::int64_t>(era) * 146097 + doe - 719468;
+    }
+
+    constexpr std::size_t date_field_size = 37;
+
+    std::string_view trim_ows(std::string_view v) noexcept
+    {
+        while (!v.empty() && (v.front() == ' ' || v.front() == '\t'))
+            v.remove_prefix(1);
+        while (!v.empty() && (v.back() == ' ' || v.back() == '\t'))
+            v.remove_suffix(1);
+        return v;
+    }
+
+    // Whole of s as a decimal number, no sign
+    bool parse_u64(std::string_view s, std::uint64_t &out) noexcept
+    {
+        if (s.empty() || s[0] < '0' || s[0] > '9')
+            return false;
+        auto r = std::from_chars(s.data(), s.data() + s.size(), out);
+        return r.ec == std::errc{} && r.ptr == s.data() + s.size();
+    }
+}
+
+std::string_view swiftnet::http::status_line(int status) noexcept
+{
+    if (status < first_status || status > last_status)
+        return {};
+    return status_lines[status - first_status];
+}
+
+std::string_view swiftnet::http::reason_phrase(int status) noexcept
+{
+    return reason_of(status);
+}
+
+std::string_view swiftnet::http::date_field() noexcept
+{
+    std::time_t now = std::time(nullptr);
+    if (now != tls_date.second)
+    {
+        // "Date: " + IMF-fixdate + CRLF
+        char *p = tls_date.text.data();
+        std::memcpy(p, "Date: ", 6);
+        format_imf_date(now, p + 6);
+        std::memcpy(p + 6 + imf_date_size, "\r\n", 2);
+        tls_date.second = now;
+    }
+    return {tls_date.text.data(), date_field_size};
+}
+
+std::string swiftnet::http::http_date(std::time_t t)
+{
+    std::string out(imf_date_size, ' ');
+    format_imf_date(t, out.data());
+    return out;
+}
+
+bool swiftnet::http::parse_http_date(std::string_view s, std::time_t &t) noexcept
+{
+    // "Sun, 06 Nov 1994 08:49:37 GMT"; the obsolete forms are not accepted
+    if (s.size() != imf_date_size || s.substr(3, 2) != ", " || s.substr(25) != " GMT")
+        return false;
+
+    int day, year, hour, minute, second;
+    if (!digits(s, 5, 2, day) || !digits(s, 12, 4, year) || !digits(s, 17, 2, hour) ||
+        !digits(s, 20, 2, minute) || !digits(s, 23, 2, second) ||
+        s[7] != ' ' || s[11] != ' ' || s[16] != ' ' || s[19] != ':' || s[22] != ':')
+        return false;
+
+    std::string_view months(month_names, 36);
+    std::size_t m = months.find(s.substr(8, 3));
+    if (m == std::string_view::npos || m % 3 != 0 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+        return false;
+
+    std::int64_t days = days_from_civil(year, static_cast<int>(m / 3) + 1, day);
+    t = static_cast<std::time_t>(days * 86400 + hour * 3600 + minute * 60 + second);
+    return true;
+}
+
+bool swiftnet::http::not_modified(std::string_view if_none_match, std::string_view if_modified_since,
+                                  std::string_view etag, std::time_t last_modified) noexcept
+{
+    auto opaque = [](std::string_view tag) {
+        return tag.substr(0, 2) == "W/" ? tag.substr(2) : tag;
+    };
+
+    if (!if_none_match.empty())
+    {
+        std::string_view ours = opaque(etag);
+        std::size_t i = 0;
+        while (i < if_none_match.size())
+        {
+            char c = if_none_match[i];
+            if (c == ' ' || c == '\t' || c == ',')
+            {
+                ++i;
+                continue;
+            }
+            if (c == '*')
+                return true;
+
+            // [W/]"opaque"; a comma may sit inside the quotes
+            std::size_t begin = i;
+            if (if_none_match.substr(i, 2) == "W/")
+                i += 2;
+            if (i >= if_none_match.size() || if_none_match[i] != '"')
+                return false;
+            std::size_t close = if_none_match.find('"', i + 1);
+            if (close == std::string_view::npos)
+                return false;
+            if (opaque(if_none_match.substr(begin, close + 1 - begin)) == ours)
+                return true;
+            i = close + 1;
+        }
+        return false;
+    }
+
+    std::time_t since;
+    return !if_modified_since.empty() && parse_http_date(if_modified_since, since) && last_modified <= since;
+}
+
+range_result swiftnet::http::parse_range(std::string_view value, std::uint64_t size, std::vector<byte_range> &out)
+{
+    out.clear();
+    value = trim_ows(value);
+    if (value.size() < 6 || !iequals(value.substr(0, 6), "bytes="))
+        return range_result::ignore;
+    value.remove_prefix(6);
+
+    // Whether any range-spec was given, satisfiable or not
+    bool any = false;
+    while (!value.empty())
+    {
+        std::size_t comma = value.find(',');
+        std::string_view item = trim_ows(value.substr(0, comma));
+        value.remove_prefix(comma == std::string_view::npos ? value.size() : comma + 1);
+        if (item.empty())
+            continue;
+
+        std::size_t dash = item.find('-');
+        if (dash == std::string_view::npos)
+            return range_result::ignore;
+        std::string_view first = item.substr(0, dash);
+        std::string_view last = item.substr(dash + 1);
+        any = true;
+
+        std::uint64_t a, b;
+        if (first.empty())
+        {
+            // "-n": the final n bytes
+            if (!parse_u64(last, b))
+                return range_result::ignore;
+            if (b == 0 || size == 0)
+                continue;
+            a = b < size ? size - b : 0;
+            b = size - 1;
+        }
+        else
+        {
+            if (!parse_u64(first, a) || (!last.empty() && !parse_u64(last, b)))
+                return range_result::ignore;
+            if (last.empty())
+                b = size - 1;
+            else if (b < a)
+                return range_result::ignore;
+            if (a >= size)
+                continue;
+            b = std::min(b, size - 1);
+        }
+
+        if (out.size() == max_ranges)
+        {
+            out.clear();
+            return range_result::ignore;
+        }
+        out.push_back({a, b - a + 1});
+    }
+    if (!any)
+        return range_result::ignore; // "bytes=" with no range-spec is malformed
+    return out.empty() ? range_result::unsatisfiable : range_result::satisfiable;
+}
+
+bool swiftnet::http::if_range_matches(std::string_view if_range, std::string_view etag, std::time_t last_modified) noexcept
+{
+    if_range = trim_ows(if_range);
+    if (if_range.empty())
+        return true;
+    // Entity-tags compare strongly here, so a weak one never matches
+    if (if_range.front() == '"' || if_range.substr(0, 2) == "W/")
+        return if_range == etag && etag.substr(0, 2) != "W/";
+    std::time_t t;
+    return parse_http_date(if_range, t) && t == last_modified;
+}
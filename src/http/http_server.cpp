@@ -1,130 +1,378 @@
 #include "http/http_server.hpp"
+#include "http/headers.hpp"
 #include "io_awaitable.hpp"
 #include "io_context.hpp"
-#include <array>
-#include <sstream>
+#include "log.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <random>
 #include <string_view>
-#include <iostream>
+#include <vector>
 
 using namespace swiftnet;
 using namespace swiftnet::http;
 
-static bool parse_request(const std::string &data, request &req, std::size_t &consumed)
-{
-    auto pos_end = data.find("\r\n\r\n");
-    if (pos_end == std::string::npos)
-        return false; // incomplete
-    std::string_view header_view(data.data(), pos_end + 4);
-    consumed = pos_end + 4;
-
-    std::string header_str(header_view);
-    std::istringstream iss(header_str);
-    std::string line;
-    if (!std::getline(iss, line))
-        return false;
-    if (!line.empty() && line.back() == '\r')
-        line.pop_back();
-    std::istringstream l0(line);
-    if (!(l0 >> req.method >> req.path))
-        return false;
-    // header lines
-    while (std::getline(iss, line))
+namespace
+{
+    // After refusing a request, how much of the rest of its upload is read
+    // and thrown away so the client gets to see the error
+    constexpr std::size_t max_linger_bytes = 1024 * 1024;
+    constexpr std::chrono::milliseconds linger_timeout{2000};
+
+    constexpr std::string_view continue_response = "HTTP/1.1 100 Continue\r\n\r\n";
+
+    /* Responses to pipelined requests, held back until the connection has
+     * to wait for input (or closes) and then sent with one gathered write.
+     * Heads share one buffer; each body goes out as its own iovec, and a
+     * file body through sendfile, so bodies are never copied.
+     */
+    class response_batch
     {
-        if (line == "\r" || line == "" || line == "\n")
-            break;
-        if (line.back() == '\r')
-            line.pop_back();
-        auto colon = line.find(":");
-        if (colon == std::string::npos)
-            continue;
-        std::string key = line.substr(0, colon);
-        std::string value = line.substr(colon + 1);
-        if (!value.empty() && value.front() == ' ')
-            value.erase(0, 1);
-        req.headers[std::move(key)] = std::move(value);
+    public:
+        // Past this many queued responses the batch is flushed regardless
+        static constexpr std::size_t max_responses = 64;
+
+        bool empty() const noexcept { return queued_.empty(); }
+        bool full() const noexcept { return queued_.size() >= max_responses; }
+
+        // Returns the bytes the response adds to the connection's output
+        std::uint64_t add(response &&res)
+        {
+            std::size_t offset = heads_.size();
+            res.write_head(heads_);
+            std::uint64_t bytes = heads_.size() - offset;
+            if (res.serialized)
+                bytes += res.serialized->head.size() + res.serialized->body.size();
+            else
+                bytes += res.content_length();
+            queued_.push_back({offset, heads_.size() - offset, std::move(res)});
+            return bytes;
+        }
+
+        // Returns -1 if the write failed; the batch is empty afterwards
+        vthread_base<int> flush(net::tcp_socket &sock)
+        {
+            // In-memory parts are gathered up to each file range, which then
+            // goes out with sendfile before the next group. iovecs are built
+            // only now: heads_ may have moved while responses were added.
+            int result = 0;
+            iov_.clear();
+            for (auto &q : queued_)
+            {
+                if (q.res.serialized)
+                {
+                    const auto &sr = *q.res.serialized;
+                    iov_.push_back({const_cast<char *>(sr.head.data()), sr.head.size()});
+                    iov_.push_back({heads_.data() + q.head_offset, q.head_length});
+                    if (!sr.body.empty())
+                        iov_.push_back({const_cast<char *>(sr.body.data()), sr.body.size()});
+                    continue;
+                }
+                iov_.push_back({heads_.data() + q.head_offset, q.head_length});
+                if (q.res.file)
+                {
+                    for (auto &seg : q.res.segments)
+                    {
+                        if (!seg.prefix.empty())
+                            iov_.push_back({seg.prefix.data(), seg.prefix.size()});
+                        if (seg.length == 0)
+                            continue;
+                        if (co_await sock.async_writev(iov_.data(), iov_.size()) < 0 ||
+                            co_await sock.async_sendfile(q.res.file->fd(), seg.offset, seg.length) < 0)
+                        {
+                            result = -1;
+                            break;
+                        }
+                        iov_.clear();
+                    }
+                    if (result < 0)
+                        break;
+                }
+                if (!q.res.body.empty())
+                    iov_.push_back({q.res.body.data(), q.res.body.size()});
+            }
+            if (result == 0 && !iov_.empty() && co_await sock.async_writev(iov_.data(), iov_.size()) < 0)
+                result = -1;
+
+            queued_.clear();
+            heads_.clear();
+            co_return result;
+        }
+
+    private:
+        struct queued_response
+        {
+            std::size_t head_offset;
+            std::size_t head_length;
+            response res;
+        };
+
+        std::vector<queued_response> queued_;
+        std::string heads_;
+        std::vector<iovec> iov_;
+    };
+}
+
+void response::set_header(std::string_view name, std::string_view value)
+{
+    for (auto &[k, v] : headers)
+    {
+        if (iequals(k, name))
+        {
+            v.assign(value);
+            return;
+        }
+    }
+    headers.emplace_back(name, value);
+}
+
+void response::send_file(std::shared_ptr<const open_file> f, std::uint64_t offset, std::uint64_t length)
+{
+    body.clear();
+    file = std::move(f);
+    segments.clear();
+    segments.push_back({{}, offset, length});
+}
+
+void response::send_file_ranges(std::shared_ptr<const open_file> f, std::span<const byte_range> ranges,
+                                std::string_view content_type)
+{
+    // The boundary only has to be absent from the parts; the file's bytes
+    // are not scanned, so make a collision vanishingly unlikely instead
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    char boundary[16];
+    std::uint64_t bits = rng();
+    for (char &c : boundary)
+    {
+        c = "0123456789abcdef"[bits & 15];
+        bits >>= 4;
+    }
+    std::string_view b(boundary, sizeof(boundary));
+
+    std::string size = std::to_string(f->size());
+    segments.clear();
+    for (const auto &r : ranges)
+    {
+        std::string &prefix = segments.emplace_back(file_segment{{}, r.offset, r.length}).prefix;
+        if (segments.size() > 1)
+            prefix += "\r\n";
+        prefix += "--";
+        prefix += b;
+        prefix += "\r\nContent-Type: ";
+        prefix += content_type;
+        prefix += "\r\nContent-Range: bytes ";
+        prefix += std::to_string(r.offset);
+        prefix += '-';
+        prefix += std::to_string(r.offset + r.length - 1);
+        prefix += '/';
+        prefix += size;
+        prefix += "\r\n\r\n";
+    }
+    body = "\r\n--";
+    body += b;
+    body += "--\r\n";
+    file = std::move(f);
+    set_header("Content-Type", "multipart/byteranges; boundary=" + std::string(b));
+}
+
+std::uint64_t response::content_length() const noexcept
+{
+    std::uint64_t n = body.size();
+    if (file)
+    {
+        for (const auto &seg : segments)
+            n += seg.prefix.size() + seg.length;
     }
-    // simple: no body parsing (only GET/HEAD)
-    req.body.clear();
-    return true;
+    return n;
+}
+
+void response::drop_body()
+{
+    if (serialized)
+    {
+        // The stored head already has the length
+        if (!serialized->body.empty())
+            serialized = std::make_shared<serialized_response>(serialized_response{serialized->head, {}});
+        return;
+    }
+    bool bodiless = status < 200 || status == 204 || status == 304;
+    bool has_length = std::any_of(headers.begin(), headers.end(),
+                                  [](const auto &h) { return iequals(h.first, "Content-Length"); });
+    if (!bodiless && !has_length)
+        set_header("Content-Length", std::to_string(content_length()));
+    body.clear();
+    file.reset();
+    segments.clear();
+}
+
+namespace
+{
+    void append_field(std::string &out, std::string_view name, std::string_view value)
+    {
+        out.append(name);
+        out.append(": ");
+        out.append(value);
+        out.append("\r\n");
+    }
+
+    // Status line and fields, without the blank line. A replayable head
+    // leaves out Connection and Date, which belong to each send.
+    void write_fields(const response &r, std::string &out, bool replayable)
+    {
+        std::string_view line = status_line(r.status);
+        if (!line.empty())
+        {
+            out.append(line);
+        }
+        else
+        {
+            char code[16];
+            auto res = std::to_chars(code, code + sizeof(code), r.status);
+            out.append("HTTP/1.1 ");
+            out.append(code, res.ptr);
+            out.append(" \r\n");
+        }
+
+        bool has_length = false;
+        bool has_date = false;
+        bool has_server = false;
+        for (const auto &[k, v] : r.headers)
+        {
+            if (replayable && (iequals(k, "Connection") || iequals(k, "Date")))
+                continue;
+            has_length = has_length || iequals(k, "Content-Length");
+            has_date = has_date || iequals(k, "Date");
+            has_server = has_server || iequals(k, "Server");
+            append_field(out, k, v);
+        }
+
+        // 1xx, 204 and 304 carry no body, so no length either
+        bool bodiless = r.status < 200 || r.status == 204 || r.status == 304;
+        if (!has_length && !bodiless)
+        {
+            char digits[24];
+            auto res = std::to_chars(digits, digits + sizeof(digits), r.content_length());
+            out.append("Content-Length: ");
+            out.append(digits, res.ptr);
+            out.append("\r\n");
+        }
+        if (!has_date && !replayable)
+            out.append(date_field());
+        if (!has_server)
+            out.append(server_field);
+    }
+}
+
+void response::write_head(std::string &out) const
+{
+    if (serialized)
+    {
+        // Only the per-send part; serialized->head goes out before it
+        bool has_date = false;
+        for (const auto &[k, v] : headers)
+        {
+            has_date = has_date || iequals(k, "Date");
+            append_field(out, k, v);
+        }
+        if (!has_date)
+            out.append(date_field());
+    }
+    else
+    {
+        write_fields(*this, out, false);
+    }
+    out.append("\r\n");
+}
+
+std::shared_ptr<const serialized_response> response::serialize() const
+{
+    auto sr = std::make_shared<serialized_response>();
+    write_fields(*this, sr->head, true);
+    sr->body = body;
+    return sr;
 }
 
 std::string response::to_string() const
 {
-    std::ostringstream oss;
-    oss << "HTTP/1.1 " << status << " OK\r\n";
-    if (headers.find("Content-Length") == headers.end())
-        oss << "Content-Length: " << body.size() << "\r\n";
-    for (const auto &[k, v] : headers)
-        oss << k << ": " << v << "\r\n";
-    oss << "\r\n";
-    oss << body;
-    return oss.str();
+    std::string out;
+    if (serialized)
+        out += serialized->head;
+    write_head(out);
+    out += serialized ? serialized->body : body;
+    return out;
 }
 
 server::server(uint16_t port, int backlog) : acceptor_(port, backlog) 
 {
-    std::cout << "[DEBUG] HTTP server constructor called with port=" << port << " backlog=" << backlog << std::endl;
 }
 
 server::~server() { 
-    std::cout << "[DEBUG] HTTP server destructor called" << std::endl;
     stop(); 
 }
 
 void server::route(const std::string &method, const std::string &path, handler_t h)
 {
-    routes_.insert_or_assign(route_key{method, path}, std::move(h));
+    auto it = routes_.insert_or_assign(route_key{method, path}, std::move(h)).first;
+    if (method == "*" && path == "*")
+        catch_all_ = &it->second;
 }
 
 void server::start(std::size_t threads)
 {
-    std::cout << "[DEBUG] HTTP server::start() called with " << threads << " threads" << std::endl;
-    
     if (running_)
         return;
     running_ = true;
     
-    std::cout << "[DEBUG] Starting I/O context..." << std::endl;
-    io_context::instance().start();
-    
-    std::cout << "[DEBUG] Starting virtual thread scheduler..." << std::endl;
+    // The scheduler brings up the I/O context with one ring per core
     vthread_scheduler::instance().start(threads);
     
-    auto handler = [this](net::tcp_socket sock) {
-        vthread_scheduler::instance().schedule(client_task(std::move(sock)));
-    };
-    
-    std::cout << "[DEBUG] Scheduling acceptor async_accept..." << std::endl;
-    
-    // CRITICAL FIX: Ensure only one acceptor supervisor runs
-    bool expected = false;
-    if (!acceptor_supervisor_running_.compare_exchange_strong(expected, true)) {
-        std::cout << "[DEBUG] Acceptor supervisor already running, skipping..." << std::endl;
-        return;
-    }
-    
-    // Schedule a task that restarts the acceptor if it completes
-    vthread_scheduler::instance().schedule([this, handler]() -> vthread {
-        std::cout << "[DEBUG] Acceptor supervisor started" << std::endl;
-        
-        while (running_) {
-            try {
-                std::cout << "[DEBUG] Starting acceptor coroutine..." << std::endl;
-                co_await acceptor_.async_accept(handler);
-                std::cout << "[DEBUG] Acceptor coroutine completed normally, restarting..." << std::endl;
-            } catch (const std::exception& e) {
-                std::cout << "[DEBUG] Acceptor exception: " << e.what() << ", restarting after delay..." << std::endl;
-                // Small delay before restarting to avoid tight loop on persistent errors
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+    auto &sched = vthread_scheduler::instance();
+    traffic_.clear();
+    for (std::size_t i = 0; i <= sched.core_count(); ++i)
+        traffic_.push_back(std::make_unique<traffic_counters>());
+
+    std::size_t listeners = per_core_accept_ ? acceptor_.open_per_core(sched.core_count()) : 1;
+
+    // One accept loop per listener. With per-core listeners each loop is
+    // pinned to its core and keeps the connections it accepts there, so a
+    // connection is parsed, handled and written on the core that accepted it.
+    for (std::size_t i = 0; i < listeners; ++i)
+    {
+        if (listeners > 1)
+        {
+            // Pinned by registration rather than by where the loop first
+            // runs, which work stealing could change before it ever waits
+            if (!sched.bind_fd(acceptor_.listener_fd(i), i))
+                SWIFTNET_LOG_WARN("listener {} could not be bound to core {}", i, i);
+            sched.schedule_with_affinity(acceptor_.async_accept(i, [this, i](net::tcp_socket sock) {
+                vthread_scheduler::instance().schedule_with_affinity(client_task(std::move(sock)), i);
+            }), i);
         }
-        
-        std::cout << "[DEBUG] Acceptor supervisor exiting (server stopped)" << std::endl;
-        acceptor_supervisor_running_ = false;
-        co_return;
-    }());
-    
-    std::cout << "[DEBUG] HTTP server started successfully" << std::endl;
+        else
+        {
+            sched.schedule(acceptor_.async_accept(i, [this](net::tcp_socket sock) {
+                vthread_scheduler::instance().schedule(client_task(std::move(sock)));
+            }));
+        }
+    }
+
+    SWIFTNET_LOG_DEBUG("http server started: {} listener(s) on {} core(s)", listeners, sched.core_count());
+}
+
+void server::set_per_core_accept(bool enabled)
+{
+    per_core_accept_ = enabled;
+}
+
+void server::set_idle_timeout(std::chrono::milliseconds timeout)
+{
+    idle_timeout_ = timeout;
+}
+
+void server::set_max_body_size(std::size_t bytes)
+{
+    max_body_size_ = bytes;
 }
 
 void server::stop()
@@ -132,82 +380,260 @@ void server::stop()
     running_ = false;
 }
 
+std::vector<traffic_stats> server::traffic() const
+{
+    std::vector<traffic_stats> out;
+    out.reserve(traffic_.size());
+    for (const auto &t : traffic_)
+    {
+        out.push_back({t->opened.load(std::memory_order_relaxed), t->closed.load(std::memory_order_relaxed),
+                       t->bytes_in.load(std::memory_order_relaxed), t->bytes_out.load(std::memory_order_relaxed)});
+    }
+    return out;
+}
+
+server::traffic_counters &server::local_traffic() noexcept
+{
+    std::size_t core = vthread_scheduler::instance().current_core();
+    return *traffic_[std::min(core, traffic_.size() - 1)];
+}
+
 vthread server::client_task(net::tcp_socket sock)
 {
-    std::array<char, 8192> buf;
-    std::string accum;
-    bool keep_alive = true;
-    while (keep_alive)
+    // Idle connections expire on the core's timer wheel, one O(1) timer per wait
+    sock.set_read_timeout(idle_timeout_);
+    sock.set_write_timeout(idle_timeout_);
+
+    // Requests are parsed in place; [start, end) holds the bytes not yet consumed
+    std::vector<char> buf(8192);
+    std::size_t start = 0;
+    std::size_t end = 0;
+    request_parser parser;
+    response_batch batch;
+    int error_status = 0;
+    local_traffic().opened.fetch_add(1, std::memory_order_relaxed);
+
+    // Counted on whichever core the connection runs on at the time
+    auto count_in = [this](int n) {
+        local_traffic().bytes_in.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed);
+    };
+    auto count_out = [this](std::uint64_t n) {
+        local_traffic().bytes_out.fetch_add(n, std::memory_order_relaxed);
+    };
+
+    // Moves the unconsumed bytes to the front; parser and decoder offsets
+    // are relative to start, so they survive
+    auto compact = [&] {
+        if (start > 0)
+        {
+            std::memmove(buf.data(), buf.data() + start, end - start);
+            end -= start;
+            start = 0;
+        }
+    };
+
+    while (true)
     {
-        // ensure at least one full request in buffer
-        if (accum.find("\r\n\r\n") == std::string::npos)
+        auto state = parser.parse(buf.data() + start, end - start);
+
+        if (state == request_parser::result::incomplete)
         {
-            int n = co_await sock.async_read(buf.data(), buf.size());
-            if (n <= 0)
+            if (end == buf.size())
             {
-                sock.close();
-                co_return;
+                compact();
+                if (end == buf.size())
+                    buf.resize(buf.size() * 2); // bounded by max_head_bytes
             }
-            accum.append(buf.data(), n);
+
+            // Everything parsed so far is answered before waiting for more
+            if (!batch.empty() && co_await batch.flush(sock) < 0)
+                break;
+
+            int n = co_await sock.async_read(buf.data() + end, buf.size() - end);
+            if (n <= 0)
+                break;
+            count_in(n);
+            end += static_cast<std::size_t>(n);
             continue;
         }
 
-        while (true)
+        if (state != request_parser::result::complete)
         {
-            request req;
-            std::size_t consumed = 0;
-            if (!parse_request(accum, req, consumed))
-                break; // incomplete
+            error_status = state == request_parser::result::too_large ? 431 : 400;
+            break;
+        }
+
+        request req;
+        parser.fill(req, buf.data() + start);
+        const std::size_t head = parser.head_size();
 
-            // remove parsed request from buffer
-            accum.erase(0, consumed);
+        // Body framing is settled, and oversized bodies refused, before any
+        // body byte is buffered
+        body_framing framing = framing_of(req);
+        if (framing.type == body_framing::kind::invalid)
+        {
+            error_status = 400;
+            break;
+        }
+        if (framing.type == body_framing::kind::length && framing.length > max_body_size_)
+        {
+            error_status = 413;
+            break;
+        }
+        if (framing.type != body_framing::kind::none && req.expects_continue() && end - start == head)
+        {
+            if (!batch.empty() && co_await batch.flush(sock) < 0)
+                break;
+            if (co_await sock.async_write(continue_response.data(), continue_response.size()) < 0)
+                break;
+            count_out(continue_response.size());
+        }
 
-            // Determine keep-alive state
-            auto conn_hdr = req.headers.find("Connection");
-            bool client_keep = conn_hdr != req.headers.end() && (conn_hdr->second == "keep-alive" || conn_hdr->second == "Keep-Alive");
+        std::size_t body_len = 0;
+        std::size_t consumed = head;
+        bool body_ok = true;
 
-            response res;
-            auto it = routes_.find(route_key{req.method, req.path});
-            if (it != routes_.end())
+        if (framing.type == body_framing::kind::length)
+        {
+            // Read the whole body next to the head so the views stay contiguous
+            body_len = static_cast<std::size_t>(framing.length);
+            consumed = head + body_len;
+            if (buf.size() - start < consumed)
             {
-                it->second(req, res);
+                compact();
+                if (buf.size() < consumed)
+                    buf.resize(consumed);
             }
-            else
+            if (end - start < consumed && !batch.empty() && co_await batch.flush(sock) < 0)
+                body_ok = false;
+            while (body_ok && end - start < consumed)
             {
-                // Try catch-all route
-                auto catch_all_it = routes_.find(route_key{"*", "*"});
-                if (catch_all_it != routes_.end())
+                int n = co_await sock.async_read(buf.data() + end, buf.size() - end);
+                if (n <= 0)
                 {
-                    catch_all_it->second(req, res);
+                    body_ok = false;
+                    break;
                 }
-                else
+                count_in(n);
+                end += static_cast<std::size_t>(n);
+            }
+        }
+        else if (framing.type == body_framing::kind::chunked)
+        {
+            chunked_decoder decoder(max_body_size_);
+            while (true)
+            {
+                auto r = decoder.decode(buf.data() + start + head, end - start - head);
+                if (r == chunked_decoder::result::complete)
+                    break;
+                if (r != chunked_decoder::result::incomplete)
                 {
-                res.status = 404;
-                res.body = "Not Found";
-                res.headers["Content-Type"] = "text/plain";
+                    error_status = r == chunked_decoder::result::too_large ? 413 : 400;
+                    break;
                 }
-            }
 
-            if (client_keep)
-                res.headers["Connection"] = "keep-alive";
-            else
-                res.headers["Connection"] = "close";
+                // Drop consumed framing so the buffer only grows with payload
+                end = start + head + decoder.reclaim();
+                if (end == buf.size())
+                {
+                    compact();
+                    if (end == buf.size())
+                        buf.resize(buf.size() * 2);
+                }
 
-            std::string out = res.to_string();
-            int w = co_await sock.async_write(out.data(), out.size());
-            (void)w;
+                if (!batch.empty() && co_await batch.flush(sock) < 0)
+                {
+                    body_ok = false;
+                    break;
+                }
 
-            if (!client_keep)
-            {
-                keep_alive = false;
-                break; // will close
+                int n = co_await sock.async_read(buf.data() + end, buf.size() - end);
+                if (n <= 0)
+                {
+                    body_ok = false;
+                    break;
+                }
+                count_in(n);
+                end += static_cast<std::size_t>(n);
             }
+            body_len = decoder.size();
+            consumed = head + decoder.consumed();
+        }
+
+        if (error_status || !body_ok)
+            break;
+
+        // The buffer may have moved while the body arrived
+        parser.fill(req, buf.data() + start);
+        req.body = std::string_view(buf.data() + start + head, body_len);
+        start += consumed;
+        parser.reset();
 
-            // loop to parse next request in buffer if any; otherwise read more
-            if (accum.find("\r\n\r\n") == std::string::npos)
+        bool keep_alive = req.keep_alive();
+
+        response res;
+        // With only a catch-all (as SwiftNet registers) there is nothing to look up
+        const handler_t *handler = catch_all_;
+        if (routes_.size() > (catch_all_ ? 1u : 0u))
+        {
+            auto it = routes_.find(route_view{req.method, req.path});
+            if (it != routes_.end())
+                handler = &it->second;
+        }
+        if (handler)
+        {
+            (*handler)(req, res);
+        }
+        else
+        {
+            res.status = 404;
+            res.body = "Not Found";
+            res.set_header("Content-Type", "text/plain");
+        }
+
+        if (req.method == "HEAD")
+            res.drop_body();
+        res.set_header("Connection", keep_alive ? "keep-alive" : "close");
+
+        // Pipelined requests already in the buffer are parsed without a
+        // read, and their responses queued behind this one
+        count_out(batch.add(std::move(res)));
+        if (!keep_alive)
+            break;
+        if (batch.full() && co_await batch.flush(sock) < 0)
+            break;
+
+        if (start == end)
+            start = end = 0;
+    }
+
+    if (error_status)
+    {
+        response res;
+        res.status = error_status;
+        res.set_header("Connection", "close");
+        count_out(batch.add(std::move(res)));
+    }
+
+    // Responses still queued go out even if the client stopped sending
+    bool sent = batch.empty() || co_await batch.flush(sock) >= 0;
+
+    if (error_status && sent)
+    {
+        // Closing with unread upload data would reset the connection and
+        // could destroy the response; half-close and discard instead
+        sock.shutdown_write();
+        sock.set_read_timeout(linger_timeout);
+        for (std::size_t drained = 0; drained < max_linger_bytes;)
+        {
+            int n = co_await sock.async_read(buf.data(), buf.size());
+            if (n <= 0)
                 break;
+            drained += static_cast<std::size_t>(n);
         }
     }
+
     sock.close();
+    local_traffic().closed.fetch_add(1, std::memory_order_relaxed);
     co_return;
 }
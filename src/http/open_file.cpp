@@ -0,0 +1,77 @@
+#include "http/open_file.hpp"
+#include "detail/os_backend.hpp"
+#include <charconv>
+#include <sys/stat.h>
+
+using namespace swiftnet::http;
+
+namespace
+{
+    void append_hex(std::string &out, std::uint64_t v)
+    {
+        char digits[16];
+        auto r = std::to_chars(digits, digits + sizeof(digits), v, 16);
+        out.append(digits, r.ptr);
+    }
+
+    file_identity identity_of(const struct stat &st) noexcept
+    {
+        file_identity id;
+        id.device = static_cast<std::uint64_t>(st.st_dev);
+        id.inode = static_cast<std::uint64_t>(st.st_ino);
+        id.size = static_cast<std::uint64_t>(st.st_size);
+#if defined(SWIFTNET_PLATFORM_MACOS)
+        id.mtime_ns = static_cast<std::int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+        id.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+        return id;
+    }
+}
+
+std::shared_ptr<const open_file> open_file::open(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    // fstat on the open descriptor, so the answer is about the file sent
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    return std::make_shared<const open_file>(fd, identity_of(st));
+}
+
+bool open_file::stat(const std::string &path, file_identity &id)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    id = identity_of(st);
+    return true;
+}
+
+open_file::~open_file()
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+std::string swiftnet::http::strong_etag(const file_identity &id)
+{
+    std::string tag;
+    tag.reserve(56);
+    tag += '"';
+    append_hex(tag, id.device);
+    tag += '-';
+    append_hex(tag, id.inode);
+    tag += '-';
+    append_hex(tag, id.size);
+    tag += '-';
+    append_hex(tag, static_cast<std::uint64_t>(id.mtime_ns));
+    tag += '"';
+    return tag;
+}
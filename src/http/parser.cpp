@@ -0,0 +1,451 @@
+#include "http/parser.hpp"
+#include "http/headers.hpp"
+#include "http/http_server.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+using namespace swiftnet::http;
+
+namespace
+{
+    // First byte in [p, end) equal to a or b, nullptr if there is none
+    inline const char *find_either(const char *p, const char *end, char a, char b) noexcept
+    {
+#if defined(__AVX2__)
+        const __m256i va = _mm256_set1_epi8(a);
+        const __m256i vb = _mm256_set1_epi8(b);
+        for (; end - p >= 32; p += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            auto hits = static_cast<unsigned>(_mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb))));
+            if (hits)
+                return p + std::countr_zero(hits);
+        }
+#endif
+#if defined(__SSE4_2__)
+        const __m128i needle = _mm_setr_epi8(a, b, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            int i = _mm_cmpestri(needle, 2, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+            if (i < 16)
+                return p + i;
+        }
+#endif
+        for (; p < end; ++p)
+        {
+            if (*p == a || *p == b)
+                return p;
+        }
+        return nullptr;
+    }
+
+    // RFC 9110 token characters
+    constexpr auto tchar_table = [] {
+        std::array<bool, 256> t{};
+        for (int c = '0'; c <= '9'; ++c)
+            t[c] = true;
+        for (int c = 'a'; c <= 'z'; ++c)
+            t[c] = t[c - 'a' + 'A'] = true;
+        for (char c : std::string_view("!#$%&'*+-.^_`|~"))
+            t[static_cast<unsigned char>(c)] = true;
+        return t;
+    }();
+
+    inline bool is_token(const char *p, const char *end) noexcept
+    {
+        if (p == end)
+            return false;
+        for (; p < end; ++p)
+        {
+            if (!tchar_table[static_cast<unsigned char>(*p)])
+                return false;
+        }
+        return true;
+    }
+
+    inline std::string_view trim(std::string_view v) noexcept
+    {
+        while (!v.empty() && (v.front() == ' ' || v.front() == '\t'))
+            v.remove_prefix(1);
+        while (!v.empty() && (v.back() == ' ' || v.back() == '\t'))
+            v.remove_suffix(1);
+        return v;
+    }
+
+    // Calls fn on each trimmed, non-empty element of a comma-separated list
+    // until it returns false
+    template <typename Fn>
+    bool for_each_item(std::string_view list, Fn fn)
+    {
+        while (true)
+        {
+            std::size_t comma = list.find(',');
+            std::string_view item = trim(list.substr(0, comma));
+            if (!item.empty() && !fn(item))
+                return false;
+            if (comma == std::string_view::npos)
+                return true;
+            list.remove_prefix(comma + 1);
+        }
+    }
+
+    // Whether a comma-separated list such as a Connection value holds token
+    bool has_token(std::string_view list, std::string_view token) noexcept
+    {
+        return !for_each_item(list, [token](std::string_view item) { return !iequals(item, token); });
+    }
+
+    inline int hex_value(char c) noexcept
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        c = static_cast<char>(c | 0x20);
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    // Longest chunk extension or trailer line accepted
+    constexpr std::size_t max_chunk_line = 4096;
+}
+
+request_parser::result request_parser::parse(const char *data, std::size_t len)
+{
+    const char *end = data + len;
+
+    while (true)
+    {
+        // Header lines: find the colon on the way to the line end, so each
+        // byte is looked at once
+        if (have_request_line_ && colon_ == 0)
+        {
+            const char *p = find_either(data + pos_, end, ':', '\n');
+            if (!p)
+            {
+                pos_ = len;
+                return len > max_head_bytes ? result::too_large : result::incomplete;
+            }
+            pos_ = static_cast<std::size_t>(p - data);
+            if (*p == ':')
+                colon_ = pos_++;
+        }
+
+        const char *nl = find_either(data + pos_, end, '\n', '\n');
+        if (!nl)
+        {
+            pos_ = len;
+            return len > max_head_bytes ? result::too_large : result::incomplete;
+        }
+
+        std::size_t eol = static_cast<std::size_t>(nl - data);
+        if (eol >= max_head_bytes)
+            return result::too_large;
+
+        // Bare LF is accepted as a line terminator as well
+        std::size_t content_end = eol;
+        if (content_end > line_start_ && data[content_end - 1] == '\r')
+            --content_end;
+
+        if (!have_request_line_)
+        {
+            // Empty lines ahead of the request line are ignored (RFC 9112 2.2)
+            if (content_end != line_start_)
+            {
+                if (!parse_request_line(data, content_end))
+                    return result::bad_request;
+                have_request_line_ = true;
+            }
+        }
+        else if (content_end == line_start_)
+        {
+            head_size_ = eol + 1;
+            return result::complete;
+        }
+        else
+        {
+            if (nfields_ == max_headers)
+                return result::too_large;
+            if (!add_field(data, content_end))
+                return result::bad_request;
+        }
+
+        line_start_ = pos_ = eol + 1;
+        colon_ = 0;
+    }
+}
+
+bool request_parser::parse_request_line(const char *data, std::size_t end)
+{
+    const char *p = data + line_start_;
+    const char *e = data + end;
+
+    const char *sp1 = find_either(p, e, ' ', ' ');
+    if (!sp1 || !is_token(p, sp1))
+        return false;
+
+    const char *target = sp1 + 1;
+    const char *sp2 = find_either(target, e, ' ', ' ');
+    if (!sp2 || sp2 == target)
+        return false;
+
+    const char *version = sp2 + 1;
+    if (e - version != 8 || std::memcmp(version, "HTTP/1.", 7) != 0 || version[7] < '0' || version[7] > '9')
+        return false;
+
+    method_ = {static_cast<std::uint32_t>(p - data), static_cast<std::uint32_t>(sp1 - p)};
+    target_ = {static_cast<std::uint32_t>(target - data), static_cast<std::uint32_t>(sp2 - target)};
+    version_ = {static_cast<std::uint32_t>(version - data), 8};
+    minor_version_ = version[7] - '0';
+    return true;
+}
+
+bool request_parser::add_field(const char *data, std::size_t end)
+{
+    // Also rejects obsolete line folding, whose continuation has no colon
+    // or starts with whitespace
+    if (colon_ == 0 || colon_ > end || !is_token(data + line_start_, data + colon_))
+        return false;
+
+    std::size_t vbegin = colon_ + 1;
+    std::size_t vend = end;
+    while (vbegin < vend && (data[vbegin] == ' ' || data[vbegin] == '\t'))
+        ++vbegin;
+    while (vend > vbegin && (data[vend - 1] == ' ' || data[vend - 1] == '\t'))
+        --vend;
+
+    fields_[nfields_++] = {
+        {static_cast<std::uint32_t>(line_start_), static_cast<std::uint32_t>(colon_ - line_start_)},
+        {static_cast<std::uint32_t>(vbegin), static_cast<std::uint32_t>(vend - vbegin)}};
+    return true;
+}
+
+void request_parser::fill(request &req, const char *data)
+{
+    auto view = [data](span s) { return std::string_view(data + s.off, s.len); };
+
+    req.method = view(method_);
+    req.path = view(target_);
+    req.version = view(version_);
+    req.minor_version = minor_version_;
+
+    for (std::size_t i = 0; i < nfields_; ++i)
+        views_[i] = {view(fields_[i].name), view(fields_[i].value)};
+    req.headers = std::span<const header_field>(views_.data(), nfields_);
+}
+
+void request_parser::reset() noexcept
+{
+    pos_ = 0;
+    line_start_ = 0;
+    colon_ = 0;
+    head_size_ = 0;
+    have_request_line_ = false;
+    minor_version_ = 1;
+    nfields_ = 0;
+}
+
+std::string_view request::header(std::string_view name) const noexcept
+{
+    for (const auto &h : headers)
+    {
+        if (iequals(h.name, name))
+            return h.value;
+    }
+    return {};
+}
+
+bool request::keep_alive() const noexcept
+{
+    std::string_view connection = header("Connection");
+    if (minor_version >= 1)
+        return !has_token(connection, "close");
+    return has_token(connection, "keep-alive");
+}
+
+bool request::expects_continue() const noexcept
+{
+    return minor_version >= 1 && iequals(header("Expect"), "100-continue");
+}
+
+body_framing swiftnet::http::framing_of(const request &req) noexcept
+{
+    body_framing f;
+    bool have_length = false;
+    bool have_encoding = false;
+    bool chunked_last = false;
+
+    for (const auto &h : req.headers)
+    {
+        if (iequals(h.name, "Content-Length"))
+        {
+            // Repeats (as separate fields or a list) must all agree
+            bool ok = for_each_item(h.value, [&](std::string_view item) {
+                if (item.size() > 18)
+                    return false;
+                std::uint64_t n = 0;
+                for (char c : item)
+                {
+                    if (c < '0' || c > '9')
+                        return false;
+                    n = n * 10 + static_cast<std::uint64_t>(c - '0');
+                }
+                if (have_length && n != f.length)
+                    return false;
+                have_length = true;
+                f.length = n;
+                return true;
+            });
+            if (!ok)
+                return {body_framing::kind::invalid, 0};
+        }
+        else if (iequals(h.name, "Transfer-Encoding"))
+        {
+            // Only the final coding decides the framing
+            have_encoding = true;
+            for_each_item(h.value, [&](std::string_view item) {
+                chunked_last = iequals(item, "chunked");
+                return true;
+            });
+        }
+    }
+
+    if (have_encoding)
+    {
+        // A length next to an encoding is a request smuggling vector
+        if (have_length || !chunked_last || req.minor_version == 0)
+            return {body_framing::kind::invalid, 0};
+        return {body_framing::kind::chunked, 0};
+    }
+    if (have_length && f.length > 0)
+        f.type = body_framing::kind::length;
+    return f;
+}
+
+chunked_decoder::result chunked_decoder::decode(char *data, std::size_t len)
+{
+    if (state_ == state::done)
+        return result::complete;
+
+    while (in_ < len)
+    {
+        if (state_ == state::data)
+        {
+            auto n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk_, len - in_));
+            if (in_ != out_)
+                std::memmove(data + out_, data + in_, n);
+            in_ += n;
+            out_ += n;
+            chunk_ -= n;
+            if (chunk_ == 0)
+                state_ = state::data_cr;
+            continue;
+        }
+
+        char c = data[in_++];
+        switch (state_)
+        {
+        case state::size:
+            if (int d = hex_value(c); d >= 0)
+            {
+                if (++digits_ > 16)
+                    return result::bad_request;
+                chunk_ = chunk_ * 16 + static_cast<std::uint64_t>(d);
+                if (out_ + chunk_ > max_size_)
+                    return result::too_large;
+                break;
+            }
+            if (digits_ == 0)
+                return result::bad_request;
+            if (c == ';' || c == ' ' || c == '\t')
+            {
+                state_ = state::extension;
+                line_len_ = 0;
+                break;
+            }
+            if (c == '\r')
+            {
+                state_ = state::size_lf;
+                break;
+            }
+            if (c != '\n')
+                return result::bad_request;
+            [[fallthrough]];
+        case state::size_lf:
+            if (c != '\n')
+                return result::bad_request;
+            digits_ = 0;
+            state_ = chunk_ == 0 ? state::trailer_start : state::data;
+            break;
+
+        case state::extension:
+            if (c == '\n')
+            {
+                digits_ = 0;
+                state_ = chunk_ == 0 ? state::trailer_start : state::data;
+            }
+            else if (++line_len_ > max_chunk_line)
+            {
+                return result::bad_request;
+            }
+            break;
+
+        case state::data_cr:
+            if (c == '\r')
+                state_ = state::data_lf;
+            else if (c == '\n')
+                state_ = state::size;
+            else
+                return result::bad_request;
+            break;
+
+        case state::data_lf:
+            if (c != '\n')
+                return result::bad_request;
+            state_ = state::size;
+            break;
+
+        case state::trailer_start:
+            // Trailer fields are skipped; a blank line ends the body
+            if (c == '\r')
+            {
+                state_ = state::trailer_lf;
+            }
+            else if (c == '\n')
+            {
+                state_ = state::done;
+                return result::complete;
+            }
+            else
+            {
+                state_ = state::trailer;
+                line_len_ = 1;
+            }
+            break;
+
+        case state::trailer:
+            if (c == '\n')
+                state_ = state::trailer_start;
+            else if (++line_len_ > max_chunk_line)
+                return result::bad_request;
+            break;
+
+        case state::trailer_lf:
+            if (c != '\n')
+                return result::bad_request;
+            state_ = state::done;
+            return result::complete;
+
+        case state::data:
+        case state::done:
+            break;
+        }
+    }
+    return result::incomplete;
+}
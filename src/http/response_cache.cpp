@@ -0,0 +1,167 @@
+#include "http/response_cache.hpp"
+#include "http/headers.hpp"
+#include "vthread_scheduler.hpp"
+#include <algorithm>
+
+using namespace swiftnet;
+using namespace swiftnet::http;
+
+namespace
+{
+    // Bookkeeping charged to each entry on top of its bytes
+    constexpr std::size_t entry_overhead = 128;
+
+    std::string_view trim(std::string_view v) noexcept
+    {
+        while (!v.empty() && (v.front() == ' ' || v.front() == '\t'))
+            v.remove_prefix(1);
+        while (!v.empty() && (v.back() == ' ' || v.back() == '\t'))
+            v.remove_suffix(1);
+        return v;
+    }
+}
+
+response_cache::response_cache(std::size_t max_bytes, std::size_t shards)
+{
+    shards = std::max<std::size_t>(1, shards);
+    shard_budget_ = max_bytes / shards;
+    shards_.reserve(shards);
+    for (std::size_t i = 0; i < shards; ++i)
+        shards_.push_back(std::make_unique<shard>());
+}
+
+std::size_t response_cache::shard_of(std::string_view target, std::size_t hint) const noexcept
+{
+    if (hint < shards_.size())
+        return hint;
+    // Off the workers there is no core; spread by target instead
+    std::size_t core = vthread_scheduler::instance().current_core();
+    if (core < shards_.size())
+        return core;
+    return std::hash<std::string_view>{}(target) % shards_.size();
+}
+
+void response_cache::make_key(std::string &key, const request &req, const std::vector<std::string> &names)
+{
+    key.assign(req.path);
+    for (const auto &name : names)
+    {
+        key.push_back('\0');
+        key.append(req.header(name));
+    }
+}
+
+response_cache::lookup response_cache::find(const request &req)
+{
+    // Reused so a lookup does not allocate once the buffer has grown
+    thread_local std::string key;
+    std::size_t index = shard_of(req.path, local);
+    shard &s = *shards_[index];
+    std::lock_guard lock(s.mutex);
+
+    key.assign(req.path);
+    auto v = s.vary.find(key);
+    if (v == s.vary.end())
+        return {};
+    make_key(key, req, v->second.names);
+    auto it = s.index.find(key);
+    if (it == s.index.end())
+        return {};
+
+    entry &e = *it->second;
+    // The entry may be another user's view of the target
+    if (!e.is_public && !req.header("Authorization").empty())
+        return {};
+    auto now = clock::now();
+    if (now >= e.stale_until)
+    {
+        remove(s, it->second);
+        return {};
+    }
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    if (now < e.fresh_until || e.revalidating)
+        return {e.response, false, index};
+    e.revalidating = true;
+    return {e.response, true, index};
+}
+
+void response_cache::store(const request &req, std::string_view vary, std::shared_ptr<const serialized_response> res,
+                           clock::duration ttl, clock::duration stale, bool is_public, std::size_t hint)
+{
+    std::vector<std::string> names;
+    while (!vary.empty())
+    {
+        std::size_t comma = vary.find(',');
+        std::string_view name = trim(vary.substr(0, comma));
+        vary.remove_prefix(comma == std::string_view::npos ? vary.size() : comma + 1);
+        if (name == "*")
+            return;
+        if (!name.empty())
+            names.emplace_back(name);
+    }
+
+    std::string key;
+    make_key(key, req, names);
+    std::size_t bytes = res->head.size() + res->body.size() + 2 * key.size() + entry_overhead;
+    if (bytes > shard_budget_)
+        return;
+
+    auto now = clock::now();
+    shard &s = *shards_[shard_of(req.path, hint)];
+    std::lock_guard lock(s.mutex);
+
+    // Entries stored under earlier Vary names can no longer be found and
+    // age out with the rest
+    variants &v = s.vary[std::string(req.path)];
+    v.names = std::move(names);
+
+    auto it = s.index.find(key);
+    if (it != s.index.end())
+    {
+        entry &e = *it->second;
+        s.bytes = s.bytes - e.bytes + bytes;
+        e.response = std::move(res);
+        e.bytes = bytes;
+        e.fresh_until = now + ttl;
+        e.stale_until = now + ttl + stale;
+        e.is_public = is_public;
+        e.revalidating = false;
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+    }
+    else
+    {
+        s.lru.push_front({key, std::string(req.path), std::move(res), bytes, now + ttl, now + ttl + stale,
+                             is_public});
+        s.index.emplace(std::move(key), s.lru.begin());
+        ++v.entries;
+        s.bytes += bytes;
+    }
+
+    while (s.bytes > shard_budget_)
+        remove(s, std::prev(s.lru.end()));
+}
+
+void response_cache::erase(const request &req, std::size_t hint)
+{
+    std::string key(req.path);
+    shard &s = *shards_[shard_of(req.path, hint)];
+    std::lock_guard lock(s.mutex);
+
+    auto v = s.vary.find(key);
+    if (v == s.vary.end())
+        return;
+    make_key(key, req, v->second.names);
+    auto it = s.index.find(key);
+    if (it != s.index.end())
+        remove(s, it->second);
+}
+
+void response_cache::remove(shard &s, std::list<entry>::iterator it)
+{
+    s.bytes -= it->bytes;
+    auto v = s.vary.find(it->target);
+    if (v != s.vary.end() && --v->second.entries == 0)
+        s.vary.erase(v);
+    s.index.erase(it->key);
+    s.lru.erase(it);
+}
@@ -0,0 +1,227 @@
+#include "http/router.hpp"
+#include <stdexcept>
+
+using namespace swiftnet::http;
+
+namespace
+{
+    constexpr std::size_t no_entry = static_cast<std::size_t>(-1);
+}
+
+struct router::node
+{
+    std::string prefix;  // static text consumed on the way in
+    std::string indices; // first byte of each static child, same order as children
+    std::vector<std::unique_ptr<node>> children;
+    std::unique_ptr<node> param_child; // a :name segment continues here
+    std::size_t leaf{no_entry};     // route ending exactly at this node
+    std::size_t wildcard{no_entry}; // route ending in '*' at this node
+};
+
+namespace
+{
+    using node_t = router::node;
+    using capture_array = std::array<std::string_view, router::max_params>;
+
+    // Descends from n along s, splitting edges as needed; returns the node
+    // at which s ends
+    node_t *insert_static(node_t *n, std::string_view s)
+    {
+        while (true)
+        {
+            std::size_t common = 0;
+            while (common < n->prefix.size() && common < s.size() && n->prefix[common] == s[common])
+                ++common;
+
+            if (common < n->prefix.size())
+            {
+                // Split the edge: n keeps the shared head, the rest moves down
+                auto tail = std::make_unique<node_t>();
+                tail->prefix = n->prefix.substr(common);
+                tail->indices = std::move(n->indices);
+                tail->children = std::move(n->children);
+                tail->param_child = std::move(n->param_child);
+                tail->leaf = n->leaf;
+                tail->wildcard = n->wildcard;
+
+                n->prefix.resize(common);
+                n->indices.assign(1, tail->prefix[0]);
+                n->children.clear();
+                n->children.push_back(std::move(tail));
+                n->leaf = no_entry;
+                n->wildcard = no_entry;
+            }
+
+            s.remove_prefix(common);
+            if (s.empty())
+                return n;
+
+            std::size_t i = n->indices.find(s[0]);
+            if (i == std::string::npos)
+            {
+                auto child = std::make_unique<node_t>();
+                child->prefix = std::string(s);
+                node_t *raw = child.get();
+                n->indices.push_back(s[0]);
+                n->children.push_back(std::move(child));
+                return raw;
+            }
+            n = n->children[i].get();
+        }
+    }
+
+    bool lookup(const node_t *n, std::string_view path, capture_array &values, std::size_t &count, std::size_t &entry)
+    {
+        if (path.substr(0, n->prefix.size()) != n->prefix)
+            return false;
+        path.remove_prefix(n->prefix.size());
+
+        if (path.empty())
+        {
+            if (n->leaf != no_entry)
+            {
+                entry = n->leaf;
+                return true;
+            }
+        }
+        else
+        {
+            std::size_t i = n->indices.find(path[0]);
+            if (i != std::string::npos && lookup(n->children[i].get(), path, values, count, entry))
+                return true;
+
+            if (n->param_child)
+            {
+                std::size_t len = path.find('/');
+                if (len == std::string_view::npos)
+                    len = path.size();
+                if (len > 0 && count < values.size())
+                {
+                    values[count++] = path.substr(0, len);
+                    if (lookup(n->param_child.get(), path.substr(len), values, count, entry))
+                        return true;
+                    --count;
+                }
+            }
+        }
+
+        if (n->wildcard != no_entry && count < values.size())
+        {
+            values[count++] = path;
+            entry = n->wildcard;
+            return true;
+        }
+        return false;
+    }
+}
+
+router::router() = default;
+router::~router() = default;
+router::router(router &&) noexcept = default;
+router &router::operator=(router &&) noexcept = default;
+
+bool router::add(std::string_view method, std::string_view pattern, std::size_t id)
+{
+    // The whole pattern is checked before the tree changes, so a rejected
+    // one leaves nothing behind
+    route_entry entry{id, {}};
+    for (std::string_view rest = pattern;;)
+    {
+        std::size_t special = rest.find_first_of(":*");
+        if (special == std::string_view::npos)
+            break;
+        rest.remove_prefix(special);
+
+        if (rest[0] == '*')
+        {
+            if (rest.size() != 1)
+                throw std::runtime_error("route " + std::string(pattern) + ": '*' is only allowed at the end");
+            entry.names.emplace_back("*");
+            break;
+        }
+
+        std::size_t end = rest.find('/');
+        std::string_view name = rest.substr(1, end == std::string_view::npos ? std::string_view::npos : end - 1);
+        if (name.empty())
+            throw std::runtime_error("route " + std::string(pattern) + ": unnamed ':' parameter");
+        entry.names.emplace_back(name);
+        rest.remove_prefix(end == std::string_view::npos ? rest.size() : end);
+    }
+    if (entry.names.size() > max_params)
+        throw std::runtime_error("route " + std::string(pattern) + ": too many parameters");
+
+    node *n = nullptr;
+    for (auto &[m, root] : trees_)
+    {
+        if (m == method)
+            n = root.get();
+    }
+    if (!n)
+    {
+        trees_.emplace_back(std::string(method), std::make_unique<node>());
+        n = trees_.back().second.get();
+    }
+
+    std::size_t *slot = nullptr;
+    std::string_view rest = pattern;
+    while (true)
+    {
+        std::size_t special = rest.find_first_of(":*");
+        n = insert_static(n, rest.substr(0, special));
+        if (special == std::string_view::npos)
+        {
+            slot = &n->leaf;
+            break;
+        }
+        rest.remove_prefix(special);
+
+        if (rest[0] == '*')
+        {
+            slot = &n->wildcard;
+            break;
+        }
+
+        if (!n->param_child)
+            n->param_child = std::make_unique<node>();
+        n = n->param_child.get();
+        std::size_t end = rest.find('/');
+        rest.remove_prefix(end == std::string_view::npos ? rest.size() : end);
+    }
+
+    if (*slot != no_entry)
+        return false;
+
+    *slot = entries_.size();
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+bool router::find(std::string_view method, std::string_view path, match &m) const
+{
+    const node *root = tree(method);
+    if (!root)
+        return false;
+
+    capture_array values;
+    std::size_t count = 0;
+    std::size_t entry = no_entry;
+    if (!lookup(root, path, values, count, entry))
+        return false;
+
+    const route_entry &e = entries_[entry];
+    m.id = e.id;
+    m.nparams = count;
+    for (std::size_t i = 0; i < count; ++i)
+        m.params[i] = {e.names[i], values[i]};
+    return true;
+}
+
+auto router::tree(std::string_view method) const noexcept -> const node *
+{
+    for (const auto &[m, root] : trees_)
+    {
+        if (m == method)
+            return root.get();
+    }
+    return nullptr;
+}
@@ -1,6 +1,11 @@
 #include "io_context.hpp"
 #include "io_awaitable.hpp"
-#include <iostream>
+#include "log.hpp"
+
+#if defined(SWIFTNET_HAS_LIBURING)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 
 using namespace swiftnet;
 
@@ -18,65 +23,130 @@ void io_context::start(std::size_t threads)
         return;
     running_ = true;
     
-#if defined(SWIFTNET_BACKEND_IOURING)
-    rings_.resize(threads);
+#if defined(SWIFTNET_HAS_LIBURING)
+    rings_.reserve(threads);
     for (std::size_t i = 0; i < threads; ++i)
     {
-        if (io_uring_queue_init(1024, &rings_[i], IORING_SETUP_SINGLE_ISSUER))
-            throw std::runtime_error("io_uring init failed");
-        pollers_.emplace_back([this, i]
-                              { poll_loop(i); });
+        auto rs = std::make_unique<ring_state>();
+        // Disabled until the owning worker enables it, making that worker the single issuer
+        if (io_uring_queue_init(1024, &rs->ring, IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_R_DISABLED) != 0)
+        {
+            // Kernel without io_uring (or seccomp'd): sockets fall back to the readiness reactor
+            SWIFTNET_LOG_WARN("io_uring unavailable, using readiness I/O");
+            for (auto &r : rings_)
+                io_uring_queue_exit(&r->ring);
+            rings_.clear();
+            return;
+        }
+        rings_.push_back(std::move(rs));
     }
 #else
-    // For non-uring backends, create minimal poll threads
-    for (std::size_t i = 0; i < threads; ++i)
-    {
-        pollers_.emplace_back([this, i]
-                              { poll_loop(i); });
-    }
+    (void)threads;
 #endif
 }
 
 void io_context::stop()
 {
+    if (!running_)
+        return;
     running_ = false;
-    for (auto &p : pollers_)
-        if (p.joinable())
-            p.join();
             
-#if defined(SWIFTNET_BACKEND_IOURING)
+#if defined(SWIFTNET_HAS_LIBURING)
     for (auto &r : rings_)
-        io_uring_queue_exit(&r);
+    {
+        io_uring_queue_exit(&r->ring);
+        if (r->event_fd != -1)
+            close(r->event_fd);
+    }
     rings_.clear();
 #endif
-    pollers_.clear();
 }
 
-void io_context::poll_loop(std::size_t idx)
+bool io_context::enabled(std::size_t idx) const noexcept
 {
-#if defined(SWIFTNET_BACKEND_IOURING)
-    auto &ring = rings_[idx];
-    while (running_)
+#if defined(SWIFTNET_HAS_LIBURING)
+    return idx < rings_.size() && rings_[idx]->attached.load(std::memory_order_acquire);
+#else
+    (void)idx;
+    return false;
+#endif
+}
+
+#if defined(SWIFTNET_HAS_LIBURING)
+io_uring &io_context::ring(std::size_t idx) { return rings_[idx]->ring; }
+
+int io_context::attach(std::size_t idx)
+{
+    if (idx >= rings_.size())
+        return -1;
+
+    auto &rs = *rings_[idx];
+    if (io_uring_enable_rings(&rs.ring) != 0)
+        return -1;
+
+    rs.event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (rs.event_fd == -1 || io_uring_register_eventfd(&rs.ring, rs.event_fd) != 0)
     {
-        io_uring_cqe *cqe;
-        int ret = io_uring_wait_cqe(&ring, &cqe);
-        if (ret == 0)
-        {
-            auto *h = reinterpret_cast<std::coroutine_handle<> *>(io_uring_cqe_get_data(cqe));
-            if (h)
-                io_awaitable::complete(h, cqe->res);
-            io_uring_cqe_seen(&ring, cqe);
-        }
+        if (rs.event_fd != -1)
+            close(rs.event_fd);
+        rs.event_fd = -1;
+        return -1;
     }
-#else
-    // Simple poll loop for non-uring backends
-    while (running_)
+
+    rs.attached.store(true, std::memory_order_release);
+    return rs.event_fd;
+}
+
+io_uring_sqe *io_context::get_sqe(std::size_t idx)
+{
+    auto &rs = *rings_[idx];
+    io_uring_sqe *sqe = io_uring_get_sqe(&rs.ring);
+    if (!sqe)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // Submission queue full: push what we have and retry once
+        io_uring_submit(&rs.ring);
+        rs.pending = 0;
+        sqe = io_uring_get_sqe(&rs.ring);
+    }
+    if (sqe)
+        ++rs.pending;
+    return sqe;
+}
+
+void io_context::flush(std::size_t idx)
+{
+    if (idx >= rings_.size())
+        return;
+    auto &rs = *rings_[idx];
+    if (rs.pending)
+    {
+        io_uring_submit(&rs.ring);
+        rs.pending = 0;
     }
-#endif
 }
 
-#if defined(SWIFTNET_BACKEND_IOURING)
-io_uring &io_context::ring(std::size_t idx) { return rings_[idx]; }
+void io_context::reap(std::size_t idx)
+{
+    if (!enabled(idx))
+        return;
+    auto &rs = *rings_[idx];
+
+    // Reset the eventfd before draining so a completion posted meanwhile re-arms it
+    std::uint64_t drained;
+    [[maybe_unused]] auto r = read(rs.event_fd, &drained, sizeof(drained));
+
+    io_uring_cqe *cqes[64];
+    unsigned n;
+    while ((n = io_uring_peek_batch_cqe(&rs.ring, cqes, 64)) > 0)
+    {
+        for (unsigned i = 0; i < n; ++i)
+        {
+            auto *op = static_cast<completion_awaitable *>(io_uring_cqe_get_data(cqes[i]));
+            int res = cqes[i]->res;
+            if (op)
+                op->complete(res);
+        }
+        io_uring_cq_advance(&rs.ring, n);
+    }
+}
 #endif
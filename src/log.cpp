@@ -0,0 +1,234 @@
+#include "log.hpp"
+#include "detail/os_backend.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace swiftnet::logging;
+
+namespace
+{
+    constexpr std::size_t ring_size = 1024; // records per ring, a power of two
+    constexpr std::size_t max_rings = 64;   // threads past this share the last ring
+    constexpr std::chrono::milliseconds writer_period{5};
+
+    struct record
+    {
+        std::atomic<std::size_t> sequence;
+        level lvl;
+        clock::time_point time;
+        std::uint16_t length;
+        char text[max_message];
+    };
+
+    /* Bounded lock-free queue of records (Vyukov's sequence-numbered ring).
+     * Each thread has its own, so a worker's ring only ever has that core
+     * pushing; the shared overflow ring is why pushes still claim their
+     * slot with a CAS. Only the writer pops, under the state mutex.
+     */
+    class ring
+    {
+    public:
+        ring()
+        {
+            for (std::size_t i = 0; i < ring_size; ++i)
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool push(level l, clock::time_point t, std::string_view text) noexcept
+        {
+            std::size_t pos = head_.load(std::memory_order_relaxed);
+            record *r;
+            for (;;)
+            {
+                r = &slots_[pos & (ring_size - 1)];
+                std::size_t seq = r->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false; // full
+                }
+                else
+                {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+            r->lvl = l;
+            r->time = t;
+            r->length = static_cast<std::uint16_t>(std::min(text.size(), max_message));
+            std::memcpy(r->text, text.data(), r->length);
+            r->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        template <typename F>
+        void drain(F &&f)
+        {
+            for (;;)
+            {
+                record &r = slots_[tail_ & (ring_size - 1)];
+                if (r.sequence.load(std::memory_order_acquire) != tail_ + 1)
+                    return;
+                f(r);
+                r.sequence.store(tail_ + ring_size, std::memory_order_release);
+                ++tail_;
+            }
+        }
+
+    private:
+        std::array<record, ring_size> slots_;
+        alignas(64) std::atomic<std::size_t> head_{0};
+        alignas(64) std::size_t tail_{0};
+    };
+
+    void stderr_sink(level l, clock::time_point t, std::string_view message)
+    {
+        static constexpr const char *names[] = {"trace", "debug", "info", "warning", "error", "critical", "off"};
+        std::time_t secs = clock::to_time_t(t);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count() % 1000;
+        std::tm tm{};
+#ifdef SWIFTNET_PLATFORM_WINDOWS
+        localtime_s(&tm, &secs);
+#else
+        localtime_r(&secs, &tm);
+#endif
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        std::fprintf(stderr, "[%s.%03d] [%s] %.*s\n", stamp, static_cast<int>(ms), names[static_cast<int>(l)],
+                     static_cast<int>(message.size()), message.data());
+    }
+
+    struct state
+    {
+        std::atomic<int> threshold{static_cast<int>(level::info)};
+        std::array<std::atomic<ring *>, max_rings> rings{};
+        std::atomic<std::size_t> next_ring{0};
+        std::atomic<std::uint64_t> dropped{0};
+
+        std::mutex mutex; // the consumer side: draining and the sink
+        sink_t sink{stderr_sink};
+        std::condition_variable wake; // nobody notifies: producers never make a syscall
+        std::thread writer;
+
+        state()
+        {
+            writer = std::thread([this] {
+                std::unique_lock lock(mutex);
+                for (;;)
+                {
+                    wake.wait_for(lock, writer_period);
+                    drain_locked();
+                }
+            });
+        }
+
+        ring &local_ring()
+        {
+            thread_local ring *mine = nullptr;
+            if (mine)
+                return *mine;
+
+            std::size_t index = std::min(next_ring.fetch_add(1, std::memory_order_relaxed), max_rings - 1);
+            ring *r = rings[index].load(std::memory_order_acquire);
+            if (!r)
+            {
+                auto fresh = std::make_unique<ring>();
+                if (rings[index].compare_exchange_strong(r, fresh.get(), std::memory_order_acq_rel))
+                    r = fresh.release();
+            }
+            mine = r;
+            return *r;
+        }
+
+        void drain_locked()
+        {
+            for (auto &slot : rings)
+            {
+                ring *r = slot.load(std::memory_order_acquire);
+                if (!r)
+                    continue;
+                r->drain([this](const record &rec) {
+                    sink(rec.lvl, rec.time, std::string_view(rec.text, rec.length));
+                });
+            }
+            if (std::uint64_t n = dropped.exchange(0, std::memory_order_relaxed))
+            {
+                char msg[64];
+                int len = std::snprintf(msg, sizeof(msg), "%llu log messages dropped", static_cast<unsigned long long>(n));
+                sink(level::warn, clock::now(), std::string_view(msg, static_cast<std::size_t>(len)));
+            }
+        }
+    };
+
+    // Never destroyed: destructors of other statics, the scheduler's among
+    // them, may still log while the process exits. Whatever is queued by
+    // then is flushed from atexit, and later messages are best effort.
+    state &global()
+    {
+        static state *s = [] {
+            auto *p = new state;
+            std::atexit([] { flush(); });
+            return p;
+        }();
+        return *s;
+    }
+}
+
+void swiftnet::logging::set_level(level l) noexcept
+{
+    global().threshold.store(static_cast<int>(l), std::memory_order_relaxed);
+}
+
+level swiftnet::logging::get_level() noexcept
+{
+    return static_cast<level>(global().threshold.load(std::memory_order_relaxed));
+}
+
+bool swiftnet::logging::enabled(level l) noexcept
+{
+    return static_cast<int>(l) >= global().threshold.load(std::memory_order_relaxed);
+}
+
+void swiftnet::logging::set_sink(sink_t sink)
+{
+    state &s = global();
+    std::lock_guard lock(s.mutex);
+    // Whatever is queued goes to the sink it was logged under
+    s.drain_locked();
+    s.sink = sink ? std::move(sink) : sink_t(stderr_sink);
+}
+
+void swiftnet::logging::emit(level l, std::string_view message) noexcept
+{
+    state &s = global();
+    try
+    {
+        if (s.local_ring().push(l, clock::now(), message))
+            return;
+    }
+    catch (...)
+    {
+        // No memory for this thread's ring
+    }
+    s.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void swiftnet::logging::flush()
+{
+    state &s = global();
+    std::lock_guard lock(s.mutex);
+    s.drain_locked();
+}
@@ -0,0 +1,228 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <new>
+#include <spdlog/fmt/fmt.h>
+
+using namespace swiftnet;
+using namespace swiftnet::metrics;
+
+namespace
+{
+    // Exported bucket edges, in powers of two nanoseconds: about 1us to 17s.
+    // They fall on histogram bucket boundaries, so the counts are exact.
+    constexpr unsigned first_edge = 10;
+    constexpr unsigned last_edge = 34;
+
+    constexpr std::string_view unmatched_route = "unmatched";
+
+    void append_escaped(std::string &out, std::string_view v)
+    {
+        for (char c : v)
+        {
+            if (c == '\\' || c == '"')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (c == '\n')
+            {
+                out += "\\n";
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+
+    void write_family(std::string &out, std::string_view name, std::string_view type, std::string_view help)
+    {
+        fmt::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+    }
+
+    // One family with a sample per core
+    template <typename F>
+    void write_per_core(std::string &out, const vthread_scheduler::Stats &stats, std::string_view name,
+                        std::string_view type, std::string_view help, F value)
+    {
+        write_family(out, name, type, help);
+        for (std::size_t i = 0; i < stats.per_core.size(); ++i)
+            fmt::format_to(std::back_inserter(out), "{}{{core=\"{}\"}} {}\n", name, i, value(stats.per_core[i]));
+    }
+}
+
+std::size_t histogram::bucket_of(std::uint64_t v) noexcept
+{
+    v = std::min(v, (std::uint64_t{1} << max_exponent) - 1);
+    if (v < sub_buckets)
+        return static_cast<std::size_t>(v);
+    unsigned e = static_cast<unsigned>(std::bit_width(v)) - 1;
+    unsigned shift = e - sub_bucket_bits;
+    return (e - sub_bucket_bits + 1) * sub_buckets + static_cast<std::size_t>((v >> shift) & (sub_buckets - 1));
+}
+
+std::uint64_t histogram::bucket_floor(std::size_t i) noexcept
+{
+    if (i < sub_buckets)
+        return i;
+    unsigned e = static_cast<unsigned>(i / sub_buckets) + sub_bucket_bits - 1;
+    std::uint64_t sub = i % sub_buckets;
+    return (sub_buckets + sub) << (e - sub_bucket_bits);
+}
+
+void histogram::add_to(snapshot &s) const noexcept
+{
+    for (std::size_t i = 0; i < bucket_count; ++i)
+    {
+        std::uint64_t n = counts_[i].load(std::memory_order_relaxed);
+        s.counts[i] += n;
+        s.count += n;
+    }
+    s.sum += sum_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t histogram::snapshot::count_below(std::uint64_t v) const noexcept
+{
+    std::uint64_t n = 0;
+    for (std::size_t i = 0, end = bucket_of(v); i < end; ++i)
+        n += counts[i];
+    return n;
+}
+
+std::uint64_t histogram::snapshot::quantile(double q) const noexcept
+{
+    if (count == 0)
+        return 0;
+    auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count)));
+    rank = std::max<std::uint64_t>(rank, 1);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return i + 1 < bucket_count ? bucket_floor(i + 1) - 1 : bucket_floor(i);
+    }
+    return bucket_floor(bucket_count - 1);
+}
+
+request_metrics::request_metrics(std::vector<std::pair<std::string, std::string>> routes, std::size_t cores)
+    : routes_(std::move(routes)), series_count_((routes_.size() + 1) * status_classes)
+{
+    cores_.resize(cores + 1);
+    for (auto &c : cores_)
+        c.series.reset(new std::atomic<histogram *>[series_count_]());
+}
+
+request_metrics::~request_metrics()
+{
+    for (auto &c : cores_)
+    {
+        for (std::size_t i = 0; i < series_count_; ++i)
+            delete c.series[i].load(std::memory_order_relaxed);
+    }
+}
+
+void request_metrics::observe(std::size_t route, int status, std::uint64_t latency_ns) noexcept
+{
+    std::size_t core = std::min(vthread_scheduler::instance().current_core(), cores_.size() - 1);
+    std::size_t cls = static_cast<std::size_t>(std::clamp(status / 100, 1, 5) - 1);
+    std::size_t index = std::min(route, routes_.size()) * status_classes + cls;
+
+    std::atomic<histogram *> &slot = cores_[core].series[index];
+    histogram *h = slot.load(std::memory_order_acquire);
+    if (!h)
+    {
+        // Only the shared set can race here; the loser frees its copy
+        auto *fresh = new (std::nothrow) histogram;
+        if (!fresh)
+            return;
+        if (slot.compare_exchange_strong(h, fresh, std::memory_order_acq_rel))
+            h = fresh;
+        else
+            delete fresh;
+    }
+    h->record(latency_ns);
+}
+
+void request_metrics::write(std::string &out) const
+{
+    constexpr std::string_view name = "swiftnet_http_request_duration_seconds";
+    write_family(out, name, "histogram", "Time to produce a response, by route and status class.");
+
+    histogram::snapshot s;
+    std::string labels;
+    for (std::size_t index = 0; index < series_count_; ++index)
+    {
+        s = {};
+        for (const auto &c : cores_)
+        {
+            if (const histogram *h = c.series[index].load(std::memory_order_acquire))
+                h->add_to(s);
+        }
+        if (s.count == 0)
+            continue;
+
+        std::size_t route = index / status_classes;
+        labels.clear();
+        labels += "method=\"";
+        if (route < routes_.size())
+            append_escaped(labels, routes_[route].first);
+        labels += "\",route=\"";
+        append_escaped(labels, route < routes_.size() ? std::string_view(routes_[route].second) : unmatched_route);
+        fmt::format_to(std::back_inserter(labels), "\",code=\"{}xx\"", index % status_classes + 1);
+
+        for (unsigned e = first_edge; e <= last_edge; ++e)
+        {
+            fmt::format_to(std::back_inserter(out), "{}_bucket{{{},le=\"{}\"}} {}\n", name, labels,
+                           static_cast<double>(std::uint64_t{1} << e) / 1e9, s.count_below(std::uint64_t{1} << e));
+        }
+        fmt::format_to(std::back_inserter(out), "{}_bucket{{{},le=\"+Inf\"}} {}\n", name, labels, s.count);
+        fmt::format_to(std::back_inserter(out), "{}_sum{{{}}} {}\n", name, labels, static_cast<double>(s.sum) / 1e9);
+        fmt::format_to(std::back_inserter(out), "{}_count{{{}}} {}\n", name, labels, s.count);
+    }
+}
+
+void swiftnet::metrics::write_scheduler(std::string &out, const vthread_scheduler::Stats &stats)
+{
+    using core = vthread_scheduler::Stats::CoreStats;
+    write_per_core(out, stats, "swiftnet_scheduler_run_queue_depth", "gauge",
+                   "Tasks waiting in the core's run queue.", [](const core &c) { return c.run_queue; });
+    write_per_core(out, stats, "swiftnet_scheduler_tasks_executed_total", "counter",
+                   "Virtual thread resumptions run on the core.", [](const core &c) { return c.executed; });
+    write_per_core(out, stats, "swiftnet_scheduler_io_suspensions_total", "counter",
+                   "Virtual threads parked for I/O on the core.", [](const core &c) { return c.io_suspended; });
+    write_per_core(out, stats, "swiftnet_scheduler_steal_attempts_total", "counter",
+                   "Times the idle core looked for work on other cores.", [](const core &c) { return c.steal_attempts; });
+    write_per_core(out, stats, "swiftnet_scheduler_steals_total", "counter",
+                   "Steal attempts that found work.", [](const core &c) { return c.steals; });
+    write_per_core(out, stats, "swiftnet_scheduler_stolen_tasks_total", "counter",
+                   "Tasks the core took from other cores.", [](const core &c) { return c.stolen; });
+}
+
+void swiftnet::metrics::write_traffic(std::string &out, const std::vector<http::traffic_stats> &traffic)
+{
+    http::traffic_stats total;
+    for (const auto &t : traffic)
+    {
+        total.connections_opened += t.connections_opened;
+        total.connections_closed += t.connections_closed;
+        total.bytes_in += t.bytes_in;
+        total.bytes_out += t.bytes_out;
+    }
+    // Summed separately, so closes can briefly run ahead of opens
+    std::uint64_t active = total.connections_opened > total.connections_closed
+                               ? total.connections_opened - total.connections_closed
+                               : 0;
+
+    auto sample = [&out](std::string_view name, std::string_view type, std::string_view help, std::uint64_t v) {
+        write_family(out, name, type, help);
+        fmt::format_to(std::back_inserter(out), "{} {}\n", name, v);
+    };
+    sample("swiftnet_http_connections_active", "gauge", "Open client connections.", active);
+    sample("swiftnet_http_connections_total", "counter", "Client connections accepted.", total.connections_opened);
+    sample("swiftnet_http_received_bytes_total", "counter", "Bytes read from clients.", total.bytes_in);
+    sample("swiftnet_http_sent_bytes_total", "counter", "Response bytes queued for clients.", total.bytes_out);
+}
@@ -4,7 +4,7 @@
 #include "vthread_scheduler.hpp"
 #include "detail/os_backend.hpp"
 #include <cstring>
-#include <iostream>
+#include "log.hpp"
 
 #ifdef SWIFTNET_PLATFORM_WINDOWS
     #include <poll.h>
@@ -18,77 +18,87 @@
 
 using namespace swiftnet::net;
 
-acceptor::acceptor(uint16_t port, int backlog)
+acceptor::acceptor(uint16_t port, int backlog) : port_(port), backlog_(backlog)
 {
     // Initialize networking on Windows
     detail::platform::init_networking();
-    
+
+    listen_fds_.push_back(open_listener());
+}
+
+acceptor::~acceptor() { 
+    for (int fd : listen_fds_)
+    {
+        vthread_scheduler::instance().release_fd(fd);
+        detail::platform::close_socket(fd);
+    }
+    detail::platform::cleanup_networking();
+}
+
+int acceptor::open_listener()
+{
 #ifdef SWIFTNET_PLATFORM_WINDOWS
-    listen_fd_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 #else
-    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
 #endif
     
-    if (listen_fd_ < 0)
+    if (fd < 0)
         throw std::runtime_error("socket creation failed");
 
-    std::cout << "[DEBUG] Created listen socket fd=" << listen_fd_ << " for port " << port << std::endl;
-
     // Set non-blocking
-    set_nonblock(listen_fd_);
-    
-    // DEBUG: Check socket flags after setting non-blocking
-    int flags = fcntl(listen_fd_, F_GETFL, 0);
-    std::cout << "[DEBUG] Socket flags after non-blocking: " << flags << " (O_NONBLOCK=" << O_NONBLOCK << ")" << std::endl;
+    set_nonblock(fd);
 
+    // SO_REUSEPORT must be set on every listener before bind() for the
+    // kernel to balance connections between them
     int opt = 1;
 #ifdef SWIFTNET_PLATFORM_WINDOWS
-    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
 #else
-    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
     #ifdef SO_REUSEPORT
-        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
     #endif
 #endif
 
-    std::cout << "[DEBUG] Set socket options (REUSEADDR, REUSEPORT)" << std::endl;
-
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
+    addr.sin_port = htons(port_);
     addr.sin_addr.s_addr = INADDR_ANY;
     
-    if (bind(listen_fd_, (sockaddr *)&addr, sizeof(addr)) < 0) {
-        detail::platform::close_socket(listen_fd_);
-        throw std::runtime_error("bind failed: " + detail::platform::get_error_string(detail::platform::get_last_socket_error()));
-    }
-    
-    std::cout << "[DEBUG] Bound socket to port " << port << std::endl;
-    
-    if (listen(listen_fd_, backlog) < 0) {
-        detail::platform::close_socket(listen_fd_);
-        throw std::runtime_error("listen failed: " + detail::platform::get_error_string(detail::platform::get_last_socket_error()));
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+        auto err = detail::platform::get_error_string(detail::platform::get_last_socket_error());
+        detail::platform::close_socket(fd);
+        throw std::runtime_error("bind failed: " + err);
     }
-
-    std::cout << "[DEBUG] Socket listening on port " << port << " fd=" << listen_fd_ << " backlog=" << backlog << std::endl;
     
-    // DEBUG: Test if the socket is immediately ready for accept (should return EAGAIN)
-    sockaddr_in test_addr{};
-    socklen_t test_len = sizeof(test_addr);
-    int test_fd = accept(listen_fd_, (sockaddr*)&test_addr, &test_len);
-    if (test_fd < 0) {
-        std::cout << "[DEBUG] Initial accept() test: " << strerror(errno) << " (expected: Resource temporarily unavailable)" << std::endl;
-    } else {
-        std::cout << "[DEBUG] WARNING: accept() immediately succeeded with fd=" << test_fd << " (unexpected!)" << std::endl;
-        close(test_fd);
+    if (listen(fd, backlog_) < 0) {
+        auto err = detail::platform::get_error_string(detail::platform::get_last_socket_error());
+        detail::platform::close_socket(fd);
+        throw std::runtime_error("listen failed: " + err);
     }
 
-    // io_awaitable will poll readability on listen_fd_ in async_accept()
+    SWIFTNET_LOG_DEBUG("listening on port {} fd={} backlog={}", port_, fd, backlog_);
+    return fd;
 }
 
-acceptor::~acceptor() { 
-    detail::platform::close_socket(listen_fd_);
-    detail::platform::cleanup_networking();
+std::size_t acceptor::open_per_core(std::size_t n)
+{
+#if defined(SO_REUSEPORT) && !defined(SWIFTNET_PLATFORM_WINDOWS)
+    while (listen_fds_.size() < n)
+    {
+        try {
+            listen_fds_.push_back(open_listener());
+        } catch (const std::exception &e) {
+            // Keep serving with the listeners we already have
+            SWIFTNET_LOG_WARN("per-core listener: {}", e.what());
+            break;
+        }
+    }
+#else
+    (void)n;
+#endif
+    return listen_fds_.size();
 }
 
 void acceptor::set_nonblock(int fd)
@@ -98,78 +108,45 @@ void acceptor::set_nonblock(int fd)
 
 swiftnet::vthread acceptor::async_accept(std::function<void(tcp_socket)> cb)
 {
-    std::cout << "[DEBUG] async_accept starting with listen_fd_=" << listen_fd_ << std::endl;
-    
-    try {
-        while (true)
+    return async_accept(0, std::move(cb));
+}
+
+swiftnet::vthread acceptor::async_accept(std::size_t idx, std::function<void(tcp_socket)> cb)
+{
+    const int listen_fd = listen_fds_.at(idx);
+
+    while (true)
+    {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+
+        // Drain the backlog; the listener is edge-triggered so we only park
+        // once accept reports it is empty. Sockets come back non-blocking.
+        int client_fd = detail::platform::platform_accept(listen_fd, (sockaddr *)&addr, &len);
+        if (client_fd >= 0)
         {
-            std::cout << "[DEBUG] async_accept: top of accept loop" << std::endl;
-            
-            sockaddr_in addr{};
-            socklen_t len = sizeof(addr);
-            
-            std::cout << "[DEBUG] async_accept: calling platform_accept on fd=" << listen_fd_ << std::endl;
-            int client_fd = detail::platform::platform_accept(listen_fd_, (sockaddr *)&addr, &len);
-            std::cout << "[DEBUG] async_accept: platform_accept returned client_fd=" << client_fd << " errno=" << errno << std::endl;
-            
-            if (client_fd >= 0)
-            {
-                std::cout << "[DEBUG] Accepted connection: client_fd=" << client_fd << std::endl;
-                // Set client socket to non-blocking
-                set_nonblock(client_fd);
-                std::cout << "[DEBUG] Calling callback with client socket" << std::endl;
-                cb(tcp_socket(client_fd));
-                std::cout << "[DEBUG] Callback completed, continuing loop" << std::endl;
-                continue;
-            }
-
-    #ifdef SWIFTNET_PLATFORM_WINDOWS
-            int error = WSAGetLastError();
-            if (error == WSAEWOULDBLOCK)
-    #else
-            std::cout << "[DEBUG] Accept failed, errno=" << errno << " EAGAIN=" << EAGAIN << " EWOULDBLOCK=" << EWOULDBLOCK << std::endl;
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-    #endif
-            {
-                std::cout << "[DEBUG] No connection ready, waiting for I/O on listen_fd_=" << listen_fd_ << std::endl;
-                
-                try {
-                    std::cout << "[DEBUG] About to co_await io_awaitable..." << std::endl;
-                    int io_result = co_await io_awaitable(listen_fd_, POLLIN, false);
-                    std::cout << "[DEBUG] I/O awaitable returned with result=" << io_result << std::endl;
-                    
-                    if (io_result == -2) {
-                        std::cout << "[DEBUG] I/O timeout (expected), continuing accept loop..." << std::endl;
-                        continue; // Timeout is expected, just try again
-                    } else if (io_result < 0) {
-                        std::cout << "[DEBUG] I/O error (" << io_result << "), continuing accept loop..." << std::endl;
-                        continue; // Other errors, try again  
-                    } else {
-                        std::cout << "[DEBUG] I/O ready, continuing to accept..." << std::endl;
-                        continue; // I/O ready, try accept again
-                    }
-                } catch (const std::exception& e) {
-                    std::cout << "[DEBUG] EXCEPTION in io_awaitable: " << e.what() << std::endl;
-                    std::cout << "[DEBUG] async_accept: exiting due to io_awaitable exception" << std::endl;
-                    co_return; // Exit the coroutine on exception
-                }
-                
-                continue;
-            }
-            else
-            {
-                std::cerr << "accept error: " << detail::platform::get_error_string(detail::platform::get_last_socket_error()) << "\n";
-                std::cout << "[DEBUG] async_accept: exiting due to accept error, errno=" << errno << std::endl;
-                co_return;
-            }
+            cb(tcp_socket(client_fd));
+            continue;
         }
-    } catch (const std::exception& e) {
-        std::cout << "[DEBUG] OUTER EXCEPTION in async_accept: " << e.what() << std::endl;
-        co_return;
-    } catch (...) {
-        std::cout << "[DEBUG] UNKNOWN EXCEPTION in async_accept" << std::endl;
+
+#ifdef SWIFTNET_PLATFORM_WINDOWS
+        int error = WSAGetLastError();
+        if (error == WSAEWOULDBLOCK)
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+#endif
+        {
+            co_await io_awaitable(listen_fd, POLLIN);
+            continue;
+        }
+
+#ifndef SWIFTNET_PLATFORM_WINDOWS
+        // The peer went away between SYN and accept; not a listener failure
+        if (errno == ECONNABORTED || errno == EINTR || errno == EPROTO)
+            continue;
+#endif
+
+        SWIFTNET_LOG_ERROR("accept error: {}", detail::platform::get_error_string(detail::platform::get_last_socket_error()));
         co_return;
     }
-    
-    std::cout << "[DEBUG] async_accept: should never reach here!" << std::endl;
 }
@@ -1,8 +1,19 @@
 #include "net/tcp_socket.hpp"
 #include "io_awaitable.hpp"
+#include "io_context.hpp"
+#include "vthread_scheduler.hpp"
 #include "detail/os_backend.hpp"
+#include <algorithm>
 #include <cstring>
 #include <errno.h>
+#include <memory>
+
+#if defined(SWIFTNET_PLATFORM_LINUX)
+    #include <sys/sendfile.h>
+#elif defined(SWIFTNET_PLATFORM_MACOS)
+    #include <sys/types.h>
+    #include <sys/uio.h>
+#endif
 
 #ifdef SWIFTNET_PLATFORM_WINDOWS
     #include <poll.h>
@@ -12,13 +23,49 @@
 
 using namespace swiftnet::net;
 
+namespace
+{
+    std::chrono::steady_clock::time_point deadline_after(std::chrono::milliseconds timeout)
+    {
+        if (timeout.count() <= 0)
+            return {};
+        return std::chrono::steady_clock::now() + timeout;
+    }
+
+    int timed_out()
+    {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+
+    // Most buffers a single sendmsg takes (IOV_MAX on Linux)
+    constexpr std::size_t max_iov = 1024;
+
+    // Drops n sent bytes from the front of [iov, iov + count)
+    void advance(iovec *&iov, std::size_t &count, std::size_t n)
+    {
+        while (count > 0 && n >= iov->iov_len)
+        {
+            n -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (n > 0)
+        {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
 tcp_socket::tcp_socket(int fd) : fd_(fd)
 {
     if (fd_ != -1)
         set_nonblock();
 }
 
-tcp_socket::tcp_socket(tcp_socket &&o) noexcept : fd_(o.fd_) { o.fd_ = -1; }
+tcp_socket::tcp_socket(tcp_socket &&o) noexcept
+    : fd_(o.fd_), read_timeout_(o.read_timeout_), write_timeout_(o.write_timeout_) { o.fd_ = -1; }
 
 tcp_socket &tcp_socket::operator=(tcp_socket &&o) noexcept
 {
@@ -26,6 +73,8 @@ tcp_socket &tcp_socket::operator=(tcp_socket &&o) noexcept
     {
         close();
         fd_ = o.fd_;
+        read_timeout_ = o.read_timeout_;
+        write_timeout_ = o.write_timeout_;
         o.fd_ = -1;
     }
     return *this;
@@ -42,28 +91,50 @@ void tcp_socket::close()
 {
     if (fd_ != -1)
     {
+        // Drop the reactor registration before the number can be reused
+        vthread_scheduler::instance().release_fd(fd_);
         detail::platform::close_socket(fd_);
         fd_ = -1;
     }
 }
 
+void tcp_socket::shutdown_write()
+{
+    if (fd_ == -1)
+        return;
+#ifdef SWIFTNET_PLATFORM_WINDOWS
+    ::shutdown(fd_, SD_SEND);
+#else
+    ::shutdown(fd_, SHUT_WR);
+#endif
+}
+
 swiftnet::vthread_base<int> tcp_socket::async_read(void *buf, std::size_t len)
 {
-    std::size_t read_total = 0;
-    while (read_total < len)
+    auto deadline = deadline_after(read_timeout_);
+
+#if defined(SWIFTNET_HAS_LIBURING)
+    // Completion mode: one IORING_OP_RECV, resumed straight from its CQE
+    if (io_context::instance().enabled(vthread_scheduler::instance().current_core()))
+    {
+        int r = co_await completion_awaitable::recv(fd_, buf, len, deadline);
+        if (r == -ETIMEDOUT)
+            co_return timed_out();
+        if (r != -ENOSYS && r != -EBUSY)
+            co_return r < 0 ? -1 : r;
+    }
+#endif
+
+    // Readiness mode: returns as soon as some bytes (or EOF) are available
+    while (true)
     {
 #ifdef SWIFTNET_PLATFORM_WINDOWS
-        ssize_t r = recv(fd_, (char *)buf + read_total, len - read_total, 0);
+        ssize_t r = recv(fd_, (char *)buf, len, 0);
 #else
-        ssize_t r = ::read(fd_, (char *)buf + read_total, len - read_total);
+        ssize_t r = ::read(fd_, buf, len);
 #endif
-        if (r > 0)
-        {
-            read_total += r;
-            continue;
-        }
-        if (r == 0)
-            co_return static_cast<int>(read_total);
+        if (r >= 0)
+            co_return static_cast<int>(r);
             
 #ifdef SWIFTNET_PLATFORM_WINDOWS
         int error = WSAGetLastError();
@@ -71,20 +142,46 @@ swiftnet::vthread_base<int> tcp_socket::async_read(void *buf, std::size_t len)
 #else
         if (errno == EAGAIN || errno == EWOULDBLOCK)
 #endif
-            co_await io_awaitable(fd_, POLLIN);
-        else
+        {
+            if (co_await io_awaitable(fd_, POLLIN, deadline) == -ETIMEDOUT)
+                co_return timed_out();
+        }
+        else if (errno != EINTR)
             co_return -1;
     }
-    co_return static_cast<int>(read_total);
 }
 
 swiftnet::vthread_base<int> tcp_socket::async_write(const void *buf, std::size_t len)
 {
     std::size_t written = 0;
+    auto deadline = deadline_after(write_timeout_); // covers the whole buffer
+
+#if defined(SWIFTNET_HAS_LIBURING)
+    // Completion mode: IORING_OP_SEND until everything is queued in the kernel
+    if (io_context::instance().enabled(vthread_scheduler::instance().current_core()))
+    {
+        while (written < len)
+        {
+            int w = co_await completion_awaitable::send(fd_, (const char *)buf + written, len - written, deadline);
+            if (w == -ENOSYS || w == -EBUSY)
+                break; // no ring on this core after all - finish in readiness mode
+            if (w == -ETIMEDOUT)
+                co_return timed_out();
+            if (w < 0)
+                co_return -1;
+            written += static_cast<std::size_t>(w);
+        }
+        if (written == len)
+            co_return static_cast<int>(written);
+    }
+#endif
+
     while (written < len)
     {
 #ifdef SWIFTNET_PLATFORM_WINDOWS
         ssize_t w = send(fd_, (const char *)buf + written, len - written, 0);
+#elif defined(SWIFTNET_PLATFORM_LINUX)
+        ssize_t w = ::send(fd_, (const char *)buf + written, len - written, MSG_NOSIGNAL);
 #else
         ssize_t w = ::write(fd_, (const char *)buf + written, len - written);
 #endif
@@ -100,9 +197,139 @@ swiftnet::vthread_base<int> tcp_socket::async_write(const void *buf, std::size_t
 #else
         if (errno == EAGAIN || errno == EWOULDBLOCK)
 #endif
-            co_await io_awaitable(fd_, POLLOUT);
-        else
+        {
+            if (co_await io_awaitable(fd_, POLLOUT, deadline) == -ETIMEDOUT)
+                co_return timed_out();
+        }
+        else if (errno != EINTR)
             co_return -1;
     }
     co_return static_cast<int>(written);
 }
+
+swiftnet::vthread_base<int> tcp_socket::async_writev(iovec *iov, std::size_t count)
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        total += iov[i].iov_len;
+    advance(iov, count, 0); // skip leading empty buffers
+    auto deadline = deadline_after(write_timeout_); // covers every buffer
+
+#if defined(SWIFTNET_HAS_LIBURING)
+    // Completion mode: IORING_OP_SENDMSG over the remaining buffers
+    if (io_context::instance().enabled(vthread_scheduler::instance().current_core()))
+    {
+        msghdr msg{};
+        while (count > 0)
+        {
+            msg.msg_iov = iov;
+            msg.msg_iovlen = std::min(count, max_iov);
+            int w = co_await completion_awaitable::sendmsg(fd_, &msg, deadline);
+            if (w == -ENOSYS || w == -EBUSY)
+                break; // no ring on this core after all - finish in readiness mode
+            if (w == -ETIMEDOUT)
+                co_return timed_out();
+            if (w < 0)
+                co_return -1;
+            advance(iov, count, static_cast<std::size_t>(w));
+        }
+        if (count == 0)
+            co_return static_cast<int>(total);
+    }
+#endif
+
+    while (count > 0)
+    {
+#ifdef SWIFTNET_PLATFORM_WINDOWS
+        ssize_t w = send(fd_, (const char *)iov->iov_base, iov->iov_len, 0);
+#elif defined(SWIFTNET_PLATFORM_LINUX)
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = std::min(count, max_iov);
+        ssize_t w = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+#else
+        ssize_t w = ::writev(fd_, iov, static_cast<int>(std::min(count, max_iov)));
+#endif
+        if (w > 0)
+        {
+            advance(iov, count, static_cast<std::size_t>(w));
+            continue;
+        }
+
+#ifdef SWIFTNET_PLATFORM_WINDOWS
+        int error = WSAGetLastError();
+        if (error == WSAEWOULDBLOCK)
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+#endif
+        {
+            if (co_await io_awaitable(fd_, POLLOUT, deadline) == -ETIMEDOUT)
+                co_return timed_out();
+        }
+        else if (errno != EINTR)
+            co_return -1;
+    }
+    co_return static_cast<int>(total);
+}
+
+swiftnet::vthread_base<int> tcp_socket::async_sendfile(int file_fd, std::uint64_t offset, std::uint64_t length)
+{
+    // Files can be far larger than anything buffered, so the timeout limits
+    // how long the socket may stall rather than the whole transfer
+    auto deadline = deadline_after(write_timeout_);
+
+    // io_uring has no direct file-to-socket op (IORING_OP_SPLICE needs a
+    // pipe in between), so this runs in readiness mode on every backend
+#if defined(SWIFTNET_PLATFORM_LINUX) || defined(SWIFTNET_PLATFORM_MACOS)
+    while (length > 0)
+    {
+        // Bounded chunks keep one call from monopolising the worker
+        std::uint64_t chunk = std::min<std::uint64_t>(length, 1u << 20);
+#if defined(SWIFTNET_PLATFORM_LINUX)
+        off_t off = static_cast<off_t>(offset);
+        ssize_t w = ::sendfile(fd_, file_fd, &off, chunk);
+        if (w == 0)
+            co_return -1; // the file got shorter than announced
+#else
+        off_t sent = static_cast<off_t>(chunk);
+        ssize_t w = ::sendfile(file_fd, fd_, static_cast<off_t>(offset), &sent, nullptr, 0);
+        if (w == 0 && sent == 0)
+            co_return -1;
+        if (sent > 0)
+            w = sent; // a partial send reports EAGAIN but still moved data
+#endif
+        if (w > 0)
+        {
+            offset += static_cast<std::uint64_t>(w);
+            length -= static_cast<std::uint64_t>(w);
+            deadline = deadline_after(write_timeout_);
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            if (co_await io_awaitable(fd_, POLLOUT, deadline) == -ETIMEDOUT)
+                co_return timed_out();
+        }
+        else if (errno != EINTR)
+            co_return -1;
+    }
+    co_return 0;
+#else
+    // No sendfile: stream through one bounded buffer
+    constexpr std::size_t chunk_size = 64 * 1024;
+    auto chunk = std::make_unique<char[]>(chunk_size);
+    while (length > 0)
+    {
+        std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(length, chunk_size));
+        ssize_t r = ::pread(file_fd, chunk.get(), want, static_cast<off_t>(offset));
+        if (r <= 0)
+            co_return -1;
+        if (co_await async_write(chunk.get(), static_cast<std::size_t>(r)) < 0)
+            co_return -1;
+        offset += static_cast<std::uint64_t>(r);
+        length -= static_cast<std::uint64_t>(r);
+    }
+    co_return 0;
+#endif
+}
@@ -1,5 +1,8 @@
 #include "swiftnet.hpp"
-#include <iostream>
+#include "http/headers.hpp"
+#include "log.hpp"
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
@@ -37,8 +40,24 @@ const std::unordered_map<std::string, std::string> swiftnet::MIME_TYPES = {
 // Logger implementation
 Logger::Logger()
 {
-    logger_ = spdlog::default_logger();
-    logger_->set_level(spdlog::level::info);
+    // Levels are filtered by the facade; spdlog's queue drops the oldest
+    // message rather than block the facade's writer
+    pool_ = std::make_shared<spdlog::details::thread_pool>(8192, 1);
+    auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    logger_ = std::make_shared<spdlog::async_logger>("swiftnet", std::move(sink), pool_,
+                                                     spdlog::async_overflow_policy::overrun_oldest);
+    logger_->set_level(spdlog::level::trace);
+    
+    logging::set_sink([logger = logger_](logging::level l, logging::clock::time_point t, std::string_view message) {
+        // The facade numbers its levels as spdlog does
+        logger->log(t, spdlog::source_loc{}, static_cast<spdlog::level::level_enum>(l), message);
+    });
+}
+
+Logger::~Logger()
+{
+    logging::set_sink(nullptr);
+    logger_->flush();
 }
 
 Logger &Logger::instance()
@@ -49,31 +68,31 @@ Logger &Logger::instance()
 
 void Logger::info(const std::string &message)
 {
-    logger_->info(message);
+    if (logging::enabled(logging::level::info)) logging::emit(logging::level::info, message);
 }
 
 void Logger::warn(const std::string &message)
 {
-    logger_->warn(message);
+    if (logging::enabled(logging::level::warn)) logging::emit(logging::level::warn, message);
 }
 
 void Logger::error(const std::string &message)
 {
-    logger_->error(message);
+    if (logging::enabled(logging::level::error)) logging::emit(logging::level::error, message);
 }
 
 void Logger::debug(const std::string &message)
 {
-    logger_->debug(message);
+    if (logging::enabled(logging::level::debug)) logging::emit(logging::level::debug, message);
 }
 
 // Request implementation
 Request::Request(const http::request &req)
     : method_(req.method), path_(req.path), body_(req.body)
 {
-    // Convert std::map to std::unordered_map
+    // The parsed fields view the connection buffer; keep copies
     for (const auto &[key, value] : req.headers) {
-        headers_[key] = value;
+        headers_[std::string(key)] = std::string(value);
     }
     parse_query_string();
 }
@@ -81,7 +100,12 @@ Request::Request(const http::request &req)
 std::string Request::header(const std::string &name) const
 {
     auto it = headers_.find(name);
-    return it != headers_.end() ? it->second : "";
+    if (it != headers_.end()) return it->second;
+    // Field names are case-insensitive, and proxies often send them lowercase
+    for (const auto &[key, value] : headers_) {
+        if (http::iequals(key, name)) return value;
+    }
+    return "";
 }
 
 std::string Request::query(const std::string &name) const
@@ -92,8 +116,15 @@ std::string Request::query(const std::string &name) const
 
 std::string Request::param(const std::string &name) const
 {
-    auto it = route_params_.find(name);
-    return it != route_params_.end() ? it->second : "";
+    // Values set by hand take precedence over router captures
+    if (!route_params_.empty()) {
+        auto it = route_params_.find(name);
+        if (it != route_params_.end()) return it->second;
+    }
+    for (size_t i = 0; i < ncaptures_; ++i) {
+        if (captures_[i].name == name) return path_.substr(captures_[i].offset, captures_[i].length);
+    }
+    return "";
 }
 
 void Request::set_param(const std::string &name, const std::string &value)
@@ -101,6 +132,15 @@ void Request::set_param(const std::string &name, const std::string &value)
     route_params_[name] = value;
 }
 
+void Request::set_params(const http::router::match &m)
+{
+    ncaptures_ = m.nparams;
+    for (size_t i = 0; i < m.nparams; ++i) {
+        const auto &p = m.params[i];
+        captures_[i] = {p.name, static_cast<size_t>(p.value.data() - path_.data()), p.value.size()};
+    }
+}
+
 bool Request::is_json() const
 {
     std::string content_type = header("Content-Type");
@@ -185,6 +225,7 @@ Response &Response::text(const std::string &content)
 {
     header("Content-Type", "text/plain");
     body_ = content;
+    drop_file();
     return *this;
 }
 
@@ -192,6 +233,7 @@ Response &Response::html(const std::string &content)
 {
     header("Content-Type", "text/html");
     body_ = content;
+    drop_file();
     return *this;
 }
 
@@ -199,31 +241,174 @@ Response &Response::json(const Json &data)
 {
     header("Content-Type", "application/json");
     body_ = data.dump();
+    drop_file();
     return *this;
 }
 
 Response &Response::file(const std::string &filepath)
 {
-    try {
-        if (!utils::file_exists(filepath)) {
-            return not_found("File not found: " + filepath);
-        }
-        
-        body_ = utils::read_file(filepath);
-        header("Content-Type", utils::mime_type(filepath));
-        header("Content-Length", std::to_string(body_.size()));
-        
-        Logger::instance().debug("Serving file: " + filepath + " (" + std::to_string(body_.size()) + " bytes)");
-    } catch (const std::exception &e) {
-        Logger::instance().error("Error reading file " + filepath + ": " + e.what());
-        return internal_error("Error reading file");
+    // Only stat'ed here; finish() opens it unless a 304 makes that unnecessary
+    http::file_identity id;
+    if (!http::open_file::stat(filepath, id)) {
+        return not_found("File not found: " + filepath);
     }
+    
+    body_.clear();
+    file_.reset();
+    file_path_ = filepath;
+    header("Content-Type", utils::mime_type(filepath));
+    set_validators(http::strong_etag(id), static_cast<std::time_t>(id.mtime_ns / 1000000000));
+    return *this;
+}
+
+Response &Response::file(std::shared_ptr<const http::cached_file> f)
+{
+    body_.clear();
+    file_path_.clear();
+    header("Content-Type", f->mime_type);
+    set_validators(f->etag, f->mtime);
+    file_ = std::move(f);
     return *this;
 }
 
+void Response::set_validators(std::string etag, std::time_t last_modified)
+{
+    header("ETag", etag);
+    header("Last-Modified", http::http_date(last_modified));
+    etag_ = std::move(etag);
+    last_modified_ = last_modified;
+}
+
+void Response::drop_file()
+{
+    if (file_ || !file_path_.empty()) {
+        // A precompressed sibling labelled the response; the label goes with it
+        if (file_ && file_->coding != http::content_coding::identity) {
+            headers_.erase("Content-Encoding");
+        }
+        file_.reset();
+        file_path_.clear();
+        ranges_.clear();
+        headers_.erase("Accept-Ranges");
+        headers_.erase("ETag");
+        headers_.erase("Last-Modified");
+    }
+}
+
+void Response::vary_on_encoding()
+{
+    auto it = headers_.find("Vary");
+    if (it == headers_.end()) {
+        header("Vary", "Accept-Encoding");
+    } else if (it->second.find("Accept-Encoding") == std::string::npos && it->second != "*") {
+        it->second += ", Accept-Encoding";
+    }
+}
+
+void Response::finish(const Request &req)
+{
+    if (!file_ && file_path_.empty()) return;
+    
+    if (file_ && !file_->encoded.empty()) {
+        // Which representation is sent now depends on Accept-Encoding
+        vary_on_encoding();
+        unsigned offered = 0;
+        for (const auto &e : file_->encoded) {
+            offered |= http::coding_bit(e->coding);
+        }
+        auto coding = http::negotiate_coding(req.header("Accept-Encoding"), offered);
+        std::shared_ptr<const http::cached_file> chosen;
+        for (const auto &e : file_->encoded) {
+            if (e->coding == coding) chosen = e;
+        }
+        if (chosen) {
+            header("Content-Encoding", std::string(http::coding_name(coding)));
+            set_validators(chosen->etag, chosen->mtime);
+            file_ = std::move(chosen);
+        }
+    }
+    
+    bool safe = req.method() == "GET" || req.method() == "HEAD";
+    if (status_ == 200 && safe &&
+        http::not_modified(req.header("If-None-Match"), req.header("If-Modified-Since"), etag_, last_modified_)) {
+        // The validators stay so the client can refresh its copy's metadata
+        status_ = 304;
+        file_.reset();
+        file_path_.clear();
+        return;
+    }
+    
+    if (!file_path_.empty()) {
+        auto f = http::cached_file::load(file_path_, utils::mime_type);
+        if (!f) {
+            not_found("File not found");
+            return;
+        }
+        SWIFTNET_LOG_DEBUG("Serving file: {} ({} bytes)", file_path_, f->file->size());
+        file_path_.clear();
+        // Validators of what is actually sent, in case the file was replaced
+        set_validators(f->etag, f->mtime);
+        file_ = std::move(f);
+    }
+    
+    header("Accept-Ranges", "bytes");
+    std::string range = req.header("Range");
+    if (status_ != 200 || req.method() != "GET" || range.empty() ||
+        !http::if_range_matches(req.header("If-Range"), etag_, last_modified_)) {
+        return;
+    }
+    
+    std::uint64_t size = file_->file->size();
+    switch (http::parse_range(range, size, ranges_)) {
+    case http::range_result::satisfiable:
+        status_ = 206;
+        if (ranges_.size() == 1) {
+            const auto &r = ranges_[0];
+            header("Content-Range", "bytes " + std::to_string(r.offset) + "-" +
+                                    std::to_string(r.offset + r.length - 1) + "/" + std::to_string(size));
+        }
+        break;
+    case http::range_result::unsatisfiable:
+        drop_file();
+        headers_.erase("Content-Type");
+        body_.clear();
+        status_ = 416;
+        header("Content-Range", "bytes */" + std::to_string(size));
+        break;
+    case http::range_result::ignore:
+        break;
+    }
+}
+
+void Response::encode(const Request &req, size_t min_size)
+{
+    if (file_ || body_.size() < min_size || status_ < 200 || status_ == 204 || status_ == 206 || status_ == 304) return;
+    if (headers_.count("Content-Encoding")) return;
+    
+    auto type = headers_.find("Content-Type");
+    if (type == headers_.end() || !http::compressible_type(type->second)) return;
+    
+    vary_on_encoding();
+    auto coding = http::negotiate_coding(req.header("Accept-Encoding"), http::supported_codings());
+    std::string out;
+    if (coding == http::content_coding::identity || !http::compress(coding, body_, out) || out.size() >= body_.size()) {
+        return;
+    }
+    
+    body_ = std::move(out);
+    std::string name(http::coding_name(coding));
+    header("Content-Encoding", name);
+    // A strong ETag names exact bytes, so each coding needs its own
+    auto etag = headers_.find("ETag");
+    if (etag != headers_.end() && etag->second.size() >= 2 && etag->second.back() == '"') {
+        etag->second.insert(etag->second.size() - 1, "-" + name);
+    }
+}
+
 Response &Response::send(const std::string &content)
 {
     body_ = content;
+    drop_file();
     return *this;
 }
 
@@ -296,10 +481,19 @@ http::response Response::to_http_response() const
 {
     http::response res;
     res.status = status_;
+    res.headers.reserve(headers_.size() + 1);
     for (const auto &[key, value] : headers_) {
-        res.headers[key] = value;
+        res.headers.emplace_back(key, value);
+    }
+    if (file_ && ranges_.size() > 1) {
+        res.send_file_ranges(file_->file, ranges_, file_->mime_type);
+    } else if (file_ && ranges_.size() == 1) {
+        res.send_file(file_->file, ranges_[0].offset, ranges_[0].length);
+    } else if (file_) {
+        res.send_file(file_->file, 0, file_->file->size());
+    } else {
+        res.body = body_;
     }
-    res.body = body_;
     return res;
 }
 
@@ -323,44 +517,37 @@ SwiftNet::~SwiftNet()
 
 SwiftNet &SwiftNet::get(const std::string &path, handler_t handler)
 {
-    routes_.push_back(create_route("GET", path, handler));
-    return *this;
+    return add_route("GET", path, std::move(handler));
 }
 
 SwiftNet &SwiftNet::post(const std::string &path, handler_t handler)
 {
-    routes_.push_back(create_route("POST", path, handler));
-    return *this;
+    return add_route("POST", path, std::move(handler));
 }
 
 SwiftNet &SwiftNet::put(const std::string &path, handler_t handler)
 {
-    routes_.push_back(create_route("PUT", path, handler));
-    return *this;
+    return add_route("PUT", path, std::move(handler));
 }
 
 SwiftNet &SwiftNet::del(const std::string &path, handler_t handler)
 {
-    routes_.push_back(create_route("DELETE", path, handler));
-    return *this;
+    return add_route("DELETE", path, std::move(handler));
 }
 
 SwiftNet &SwiftNet::patch(const std::string &path, handler_t handler)
 {
-    routes_.push_back(create_route("PATCH", path, handler));
-    return *this;
+    return add_route("PATCH", path, std::move(handler));
 }
 
 SwiftNet &SwiftNet::options(const std::string &path, handler_t handler)
 {
-    routes_.push_back(create_route("OPTIONS", path, handler));
-    return *this;
+    return add_route("OPTIONS", path, std::move(handler));
 }
 
 SwiftNet &SwiftNet::head(const std::string &path, handler_t handler)
 {
-    routes_.push_back(create_route("HEAD", path, handler));
-    return *this;
+    return add_route("HEAD", path, std::move(handler));
 }
 
 SwiftNet &SwiftNet::use(middleware_t middleware)
@@ -377,13 +564,12 @@ SwiftNet &SwiftNet::use(const std::string &path, middleware_t middleware)
 
 SwiftNet &SwiftNet::static_files(const std::string &path, const std::string &root)
 {
-    return get(path + "/*", [root, path](Request &req, Response &res) {
-        std::string relative_path = req.path().substr(path.length());
-        if (relative_path.empty() || relative_path[0] != '/') {
-            relative_path = "/" + relative_path;
-        }
-        
-        std::string filepath = root + relative_path;
+    if (!file_cache_) {
+        file_cache_ = std::make_shared<http::file_cache>(utils::mime_type, file_cache_entries_, file_cache_ttl_);
+    }
+    
+    return get(path + "/*", [root, cache = file_cache_](Request &req, Response &res) {
+        std::string filepath = root + "/" + req.param("*");
         
         // Security: prevent directory traversal
         if (filepath.find("..") != std::string::npos) {
@@ -391,14 +577,22 @@ SwiftNet &SwiftNet::static_files(const std::string &path, const std::string &roo
             return;
         }
         
-        if (utils::file_exists(filepath)) {
-            res.file(filepath);
+        // Hot files come from the cache without touching the filesystem
+        if (auto f = cache->get(filepath)) {
+            res.file(std::move(f));
         } else {
             res.not_found("File not found");
         }
     });
 }
 
+SwiftNet &SwiftNet::cache(const std::string &pattern, std::chrono::milliseconds ttl,
+                          std::chrono::milliseconds stale_while_revalidate)
+{
+    cache_rules_.push_back({pattern, ttl, stale_while_revalidate});
+    return *this;
+}
+
 SwiftNet &SwiftNet::cors(const std::string &origin)
 {
     return use([origin](Request &req, Response &res, std::function<void()> next) {
@@ -435,11 +629,32 @@ SwiftNet &SwiftNet::logger()
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         
-        Logger::instance().info(
-            req.method() + " " + req.path() + " " + 
-            std::to_string(res.status()) + " " + 
-            std::to_string(duration.count()) + "ms"
-        );
+        SWIFTNET_LOG_INFO("{} {} {} {}ms", req.method(), req.path(), res.status(), duration.count());
+    });
+}
+
+SwiftNet &SwiftNet::access_log(const std::string &path, size_t max_file_bytes, size_t max_files)
+{
+    access_log_options_.path = path;
+    access_log_options_.max_file_bytes = max_file_bytes;
+    access_log_options_.max_files = max_files;
+    return *this;
+}
+
+SwiftNet &SwiftNet::metrics(const std::string &path)
+{
+    metrics_enabled_ = true;
+    return get(path, [this](Request &, Response &res) {
+        std::string out;
+        out.reserve(16 * 1024);
+        request_metrics_->write(out);
+        if (server_) {
+            metrics::write_traffic(out, server_->traffic());
+        }
+        metrics::write_scheduler(out, vthread_scheduler::instance().get_stats());
+        res.header("Content-Type", std::string(metrics::content_type))
+           .header("Cache-Control", "no-store")
+           .send(out);
     });
 }
 
@@ -455,12 +670,32 @@ void SwiftNet::listen(uint16_t port, std::function<void()> callback)
     port_ = port;
     running_ = true;
     
-    std::cout << "[DEBUG] SwiftNet::listen() called on port " << port << std::endl;
-    
     try {
-        std::cout << "[DEBUG] Creating HTTP server..." << std::endl;
+        resolve_middlewares();
+        resolve_cache_rules();
+        
+        if (!access_log_options_.path.empty()) {
+            // Route ids in the records index this table
+            std::vector<std::string> patterns;
+            patterns.reserve(routes_.size());
+            for (const auto &route : routes_) {
+                patterns.push_back(route.pattern);
+            }
+            access_log_ = std::make_unique<http::access_log>(access_log_options_, std::move(patterns), threads_);
+        }
+        if (metrics_enabled_) {
+            std::vector<std::pair<std::string, std::string>> labels;
+            labels.reserve(routes_.size());
+            for (const auto &route : routes_) {
+                labels.emplace_back(route.method, route.pattern);
+            }
+            request_metrics_ = std::make_unique<metrics::request_metrics>(std::move(labels), threads_);
+        }
+        
         server_ = std::make_unique<http::server>(port_, backlog_);
-        std::cout << "[DEBUG] HTTP server created successfully" << std::endl;
+        server_->set_per_core_accept(per_core_accept_);
+        server_->set_idle_timeout(idle_timeout_);
+        server_->set_max_body_size(max_body_size_);
         
         // Set up a single catch-all request handler that routes to SwiftNet
         auto handler = [this](const http::request &req, http::response &res) {
@@ -469,12 +704,8 @@ void SwiftNet::listen(uint16_t port, std::function<void()> callback)
         
         // Register the handler for all methods and paths
         // Use a special catch-all route pattern
-        std::cout << "[DEBUG] Registering catch-all route handler..." << std::endl;
         server_->route("*", "*", handler);
-        
-        std::cout << "[DEBUG] Starting server with " << threads_ << " threads..." << std::endl;
         server_->start(threads_);
-        std::cout << "[DEBUG] Server started successfully" << std::endl;
         
         Logger::instance().info("SwiftNet server listening on port " + std::to_string(port_) + 
                                " with " + std::to_string(threads_) + " threads");
@@ -483,16 +714,11 @@ void SwiftNet::listen(uint16_t port, std::function<void()> callback)
             callback();
         }
         
-        // Print some additional info about the sophisticated virtual thread system
-        std::cout << "SwiftNet advanced server listening on port " << port_ << std::endl;
-        std::cout << "Virtual thread scheduler is online with sophisticated I/O handling" << std::endl;
-        
         // Block until shutdown is requested
         std::unique_lock<std::mutex> lock(shutdown_mutex_);
         shutdown_cv_.wait(lock, [this]() { return shutdown_requested_; });
         
     } catch (const std::exception &e) {
-        std::cout << "[DEBUG] Exception in listen(): " << e.what() << std::endl;
         Logger::instance().error("Failed to start server: " + std::string(e.what()));
         running_ = false;
         throw;
@@ -521,6 +747,9 @@ void SwiftNet::close()
             Logger::instance().error("Error during server shutdown: " + std::string(e.what()));
         }
     }
+    
+    // Writes out whatever the workers recorded last
+    access_log_.reset();
 }
 
 SwiftNet &SwiftNet::set_threads(size_t threads)
@@ -535,121 +764,277 @@ SwiftNet &SwiftNet::set_backlog(int backlog)
     return *this;
 }
 
+SwiftNet &SwiftNet::set_per_core_accept(bool enabled)
+{
+    per_core_accept_ = enabled;
+    return *this;
+}
+
+SwiftNet &SwiftNet::set_idle_timeout(std::chrono::milliseconds timeout)
+{
+    idle_timeout_ = timeout;
+    return *this;
+}
+
+SwiftNet &SwiftNet::set_max_body_size(size_t bytes)
+{
+    max_body_size_ = bytes;
+    return *this;
+}
+
+SwiftNet &SwiftNet::set_file_cache(size_t max_entries, std::chrono::milliseconds ttl)
+{
+    file_cache_entries_ = max_entries;
+    file_cache_ttl_ = ttl;
+    return *this;
+}
+
+SwiftNet &SwiftNet::set_response_cache(size_t max_bytes)
+{
+    response_cache_bytes_ = max_bytes;
+    return *this;
+}
+
+SwiftNet &SwiftNet::set_compression(bool enabled, size_t min_size)
+{
+    compression_ = enabled;
+    compression_min_size_ = min_size;
+    return *this;
+}
+
 void SwiftNet::handle_request(const http::request &req, http::response &res)
 {
+    std::chrono::steady_clock::time_point start;
+    if (access_log_ || request_metrics_) {
+        start = std::chrono::steady_clock::now();
+    }
+    
+    // Cached GETs go out as stored, without routing or running anything
+    if (response_cache_ && req.method == "GET") {
+        auto hit = response_cache_->find(req);
+        if (hit.response) {
+            res.serialized = std::move(hit.response);
+            if (hit.revalidate) {
+                std::vector<std::pair<std::string, std::string>> fields;
+                fields.reserve(req.headers.size());
+                for (const auto &f : req.headers) {
+                    fields.emplace_back(f.name, f.value);
+                }
+                vthread_scheduler::instance().schedule(revalidate(std::string(req.path), std::move(fields), hit.shard));
+            }
+            if (access_log_ || request_metrics_) {
+                // Only for the record: the route is found here, not run.
+                // Routed like dispatch(), on the path without its query.
+                std::string_view path = req.path.substr(0, req.path.find('?'));
+                http::router::match m;
+                const Route *route = router_.find(req.method, path, m) ? &routes_[m.id] : nullptr;
+                observe(req, res, route, start, true);
+            }
+            return;
+        }
+    }
+    
     Request request(req);
     Response response;
+    const Route *route = dispatch(request, response);
+    res = response.to_http_response();
     
-    // Find matching route
-    handler_t route_handler = nullptr;
-    for (const auto &route : routes_) {
-        if (match_route(route, req.method, req.path, request)) {
-            route_handler = route.handler;
-            break;
-        }
+    if (route && route->cache_ttl.count() > 0 && req.method == "GET") {
+        cache_response(req, res, *route, http::response_cache::local);
     }
     
-    if (route_handler) {
+    if (access_log_ || request_metrics_) {
+        observe(req, res, route, start, false);
+    }
+}
+
+void SwiftNet::observe(const http::request &req, const http::response &res, const Route *route,
+                       std::chrono::steady_clock::time_point start, bool cached)
+{
+    auto latency_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    size_t route_id = route ? static_cast<size_t>(route - routes_.data()) : routes_.size();
+    
+    if (request_metrics_) {
+        request_metrics_->observe(route_id, res.status, latency_ns);
+    }
+    if (!access_log_) return;
+    
+    size_t core = vthread_scheduler::instance().current_core();
+    http::access_record r{};
+    r.time_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    r.latency_ns = latency_ns;
+    r.bytes = res.serialized ? res.serialized->body.size() : res.content_length();
+    r.status = static_cast<uint16_t>(res.status); // only 200s are cached
+    r.route = static_cast<uint16_t>(route ? std::min<size_t>(route_id, http::no_route) : http::no_route);
+    r.method = static_cast<uint8_t>(http::method_code(req.method));
+    r.core = static_cast<uint8_t>(std::min<size_t>(core, http::no_core));
+    r.flags = cached ? http::access_cached : 0;
+    access_log_->record(r);
+}
+
+const Route *SwiftNet::dispatch(Request &request, Response &response)
+{
+    const Route *route = nullptr;
+    http::router::match m;
+    if (router_.find(request.method(), request.path(), m)) {
+        route = &routes_[m.id];
+        request.set_params(m);
         try {
-            apply_middlewares(request, response, route_handler);
+            apply_middlewares(request, response, *route);
+            response.finish(request);
         } catch (const std::exception &e) {
             Logger::instance().error("Handler error: " + std::string(e.what()));
             response.internal_error("Internal server error");
         }
     } else {
-        response.not_found("Route not found: " + req.method + " " + req.path);
+        response.not_found("Route not found: " + request.method() + " " + request.path());
     }
     
-    res = response.to_http_response();
+    if (compression_) {
+        response.encode(request, compression_min_size_);
+    }
+    return route;
 }
 
-bool SwiftNet::match_route(const Route &route, const std::string &method, 
-                          const std::string &path, Request &request)
+bool SwiftNet::cache_response(const http::request &req, http::response &res, const Route &route, size_t shard)
 {
-    if (route.method != method) return false;
-    
-    std::smatch matches;
-    if (!std::regex_match(path, matches, route.regex)) return false;
+    // Only complete 200s anyone may share; files have their own cache
+    if (res.status != 200 || res.file) return false;
     
-    // Extract parameters
-    for (size_t i = 0; i < route.param_names.size() && i + 1 < matches.size(); ++i) {
-        request.set_param(route.param_names[i], matches[i + 1].str());
+    std::string_view vary;
+    bool is_public = false;
+    for (const auto &[name, value] : res.headers) {
+        if (http::iequals(name, "Set-Cookie")) return false;
+        if (http::iequals(name, "Cache-Control")) {
+            if (value.find("no-store") != std::string::npos || value.find("private") != std::string::npos) {
+                return false;
+            }
+            if (value.find("public") != std::string::npos) is_public = true;
+        }
+        if (http::iequals(name, "Vary")) vary = value;
     }
+    // An authenticated response is only shared when it says it may be
+    if (!is_public && !req.header("Authorization").empty()) return false;
+    
+    auto serialized = res.serialize();
+    response_cache_->store(req, vary, serialized, route.cache_ttl, route.cache_stale, is_public, shard);
     
+    // This response goes out from the stored bytes too
+    res.headers.clear();
+    res.body.clear();
+    res.serialized = std::move(serialized);
     return true;
 }
 
-Route SwiftNet::create_route(const std::string &method, const std::string &pattern, handler_t handler)
+vthread SwiftNet::revalidate(std::string target, std::vector<std::pair<std::string, std::string>> fields, size_t shard)
 {
-    Route route;
-    route.method = method;
-    route.pattern = pattern;
-    route.handler = handler;
-    
-    // Convert Express-style patterns to regex
-    std::string regex_pattern = pattern;
-    std::regex param_regex(R"(:([\w]+))");
-    std::smatch matches;
-    
-    size_t offset = 0;
-    while (std::regex_search(regex_pattern.cbegin() + offset, regex_pattern.cend(), matches, param_regex)) {
-        route.param_names.push_back(matches[1].str());
-        size_t pos = offset + matches.position();
-        regex_pattern.replace(pos, matches.length(), "([^/]+)");
-        offset = pos + 7; // length of "([^/]+)"
+    // The original request's views are gone by now; rebuild one over copies
+    std::vector<http::header_field> headers;
+    headers.reserve(fields.size());
+    for (const auto &[name, value] : fields) {
+        headers.push_back({name, value});
     }
+    http::request req;
+    req.method = "GET";
+    req.path = target;
+    req.version = "HTTP/1.1";
+    req.headers = headers;
     
-    // Handle wildcards
-    std::replace(regex_pattern.begin(), regex_pattern.end(), '*', '.');
-    if (regex_pattern.back() != '*') {
-        regex_pattern += "$";  // Exact match
-    } else {
-        regex_pattern.pop_back();  // Remove the '.' we just added
-        regex_pattern += "*";      // Keep the wildcard
-    }
+    Request request(req);
+    Response response;
+    const Route *route = dispatch(request, response);
+    http::response res = response.to_http_response();
     
-    // Add start anchor
-    if (regex_pattern.front() != '^') {
-        regex_pattern = "^" + regex_pattern;
+    // A failed refresh drops the stale copy rather than keep serving it
+    if (!route || route->cache_ttl.count() == 0 || !cache_response(req, res, *route, shard)) {
+        response_cache_->erase(req, shard);
     }
-    
-    try {
-        route.regex = std::regex(regex_pattern);
-    } catch (const std::regex_error &e) {
-        Logger::instance().error("Invalid regex pattern for route " + pattern + ": " + e.what());
-        // Fallback to exact match
-        route.regex = std::regex("^" + std::regex_replace(pattern, std::regex(R"([.*+?^${}()|[\]\\])"), R"(\$&)") + "$");
+    co_return;
+}
+
+void SwiftNet::resolve_cache_rules()
+{
+    for (const auto &rule : cache_rules_) {
+        auto it = std::find_if(routes_.begin(), routes_.end(), [&](const Route &r) {
+            return r.method == "GET" && r.pattern == rule.pattern;
+        });
+        if (it == routes_.end()) {
+            Logger::instance().warn("cache(): no GET route " + rule.pattern);
+            continue;
+        }
+        it->cache_ttl = rule.ttl;
+        it->cache_stale = rule.stale;
+        if (!response_cache_) {
+            response_cache_ = std::make_shared<http::response_cache>(response_cache_bytes_, threads_);
+        }
     }
-    
-    return route;
 }
 
-void SwiftNet::apply_middlewares(Request &req, Response &res, handler_t final_handler)
+SwiftNet &SwiftNet::add_route(const std::string &method, const std::string &pattern, handler_t handler)
 {
-    std::vector<middleware_t> applicable_middlewares;
-    
-    // Add global middlewares
-    applicable_middlewares.insert(applicable_middlewares.end(), 
-                                 middlewares_.begin(), middlewares_.end());
-    
-    // Add path-specific middlewares
-    for (const auto &[path, middleware] : path_middlewares_) {
-        if (req.path().find(path) == 0) {
-            applicable_middlewares.push_back(middleware);
+    // The first registration of a pattern wins, as it did with linear matching
+    if (router_.add(method, pattern, routes_.size())) {
+        routes_.push_back({method, pattern, std::move(handler), {}, {}, {}});
+    } else {
+        Logger::instance().warn("Route " + method + " " + pattern + " is already registered");
+    }
+    return *this;
+}
+
+void SwiftNet::resolve_middlewares()
+{
+    for (auto &route : routes_) {
+        route.chain.clear();
+        
+        // Global middlewares
+        for (const auto &middleware : middlewares_) {
+            route.chain.push_back({&middleware, {}});
+        }
+        
+        // Path-specific middlewares, decided here wherever the pattern's static
+        // head already settles the prefix test
+        std::string_view pattern = route.pattern;
+        size_t dynamic = pattern.find_first_of(":*");
+        std::string_view fixed = pattern.substr(0, dynamic);
+        for (const auto &[path, middleware] : path_middlewares_) {
+            std::string_view prefix = path;
+            if (!prefix.empty() && prefix.back() == '*') prefix.remove_suffix(1);
+            
+            if (fixed.starts_with(prefix)) {
+                route.chain.push_back({&middleware, {}});
+            } else if (dynamic != std::string_view::npos && prefix.starts_with(fixed)) {
+                route.chain.push_back({&middleware, std::string(prefix)});
+            }
         }
     }
-    
-    // Execute middleware chain
-    size_t index = 0;
-    std::function<void()> next = [&]() {
-        if (index < applicable_middlewares.size()) {
-            applicable_middlewares[index++](req, res, next);
-        } else {
-            final_handler(req, res);
+}
+
+void SwiftNet::apply_middlewares(Request &req, Response &res, const Route &route)
+{
+    // next() only captures the cursor, which std::function stores inline, so
+    // walking the chain does not allocate
+    struct cursor {
+        const Route &route;
+        Request &req;
+        Response &res;
+        size_t index;
+        
+        void advance() {
+            while (index < route.chain.size()) {
+                const auto &link = route.chain[index++];
+                if (link.prefix.empty() || req.path().compare(0, link.prefix.size(), link.prefix) == 0) {
+                    (*link.middleware)(req, res, [this] { advance(); });
+                    return;
+                }
+            }
+            route.handler(req, res);
         }
     };
     
-    next();
+    cursor c{route, req, res, 0};
+    c.advance();
 }
 
 // Utility functions
@@ -0,0 +1,24 @@
+#include "timer.hpp"
+#include "vthread_scheduler.hpp"
+#include <thread>
+
+using namespace swiftnet;
+
+bool sleep_awaitable::await_suspend(std::coroutine_handle<> h)
+{
+    handle_ = h;
+    timer_.fire = &sleep_awaitable::on_expiry;
+    timer_.ctx = this;
+
+    if (vthread_scheduler::instance().suspend_for_timer(h, &timer_, deadline_))
+        return true;
+
+    std::this_thread::sleep_until(deadline_);
+    return false;
+}
+
+void sleep_awaitable::on_expiry(detail::timer_node *t)
+{
+    auto *self = static_cast<sleep_awaitable *>(t->ctx);
+    vthread_scheduler::instance().resume_from_io(self->handle_, 0);
+}
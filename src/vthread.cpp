@@ -3,23 +3,39 @@
 
 using namespace swiftnet;
 
+namespace
+{
+    // Hands control to the awaiting parent, or tells the scheduler the root finished
+    template <typename P>
+    std::coroutine_handle<> finish(std::coroutine_handle<P> h) noexcept
+    {
+        detail::promise_base &p = h.promise();
+        if (p.continuation) {
+            p.root->active = p.continuation;
+            return p.continuation;
+        }
+        
+        // Let the scheduler handle cleanup properly instead of destroying directly
+        vthread_scheduler::instance().notify_completion(h);
+        return std::noop_coroutine();
+    }
+}
+
 // Implementation for generic vthread_base<T>
 template <typename T>
 template <typename H>
-void vthread_base<T>::promise_type::final_awaitable::await_suspend(H h) noexcept
+std::coroutine_handle<> vthread_base<T>::promise_type::final_awaitable::await_suspend(H h) noexcept
 {
-    // Let the scheduler handle cleanup properly instead of destroying directly
-    vthread_scheduler::instance().notify_completion(h);
+    return finish(h);
 }
 
 // Implementation for vthread_base<void> specialization
 template <typename H>
-void vthread_base<void>::promise_type::final_awaitable::await_suspend(H h) noexcept
+std::coroutine_handle<> vthread_base<void>::promise_type::final_awaitable::await_suspend(H h) noexcept
 {
-    // Let the scheduler handle cleanup properly instead of destroying directly
-    vthread_scheduler::instance().notify_completion(h);
+    return finish(h);
 }
 
 // Explicit instantiations for common types
-template void vthread_base<int>::promise_type::final_awaitable::await_suspend<std::coroutine_handle<vthread_base<int>::promise_type>>(std::coroutine_handle<vthread_base<int>::promise_type>) noexcept;
-template void vthread_base<void>::promise_type::final_awaitable::await_suspend<std::coroutine_handle<vthread_base<void>::promise_type>>(std::coroutine_handle<vthread_base<void>::promise_type>) noexcept;
+template std::coroutine_handle<> vthread_base<int>::promise_type::final_awaitable::await_suspend<std::coroutine_handle<vthread_base<int>::promise_type>>(std::coroutine_handle<vthread_base<int>::promise_type>) noexcept;
+template std::coroutine_handle<> vthread_base<void>::promise_type::final_awaitable::await_suspend<std::coroutine_handle<vthread_base<void>::promise_type>>(std::coroutine_handle<vthread_base<void>::promise_type>) noexcept;
@@ -1,12 +1,42 @@
 #include "vthread_scheduler.hpp"
 #include "event_loop.hpp"
+#include "io_awaitable.hpp"
 #include "io_context.hpp"
-#include <iostream>
+#include "log.hpp"
 #include <algorithm>
 #include <cassert>
+#include <limits>
+#include <poll.h>
 
 using namespace swiftnet;
 
+namespace
+{
+    constexpr std::size_t no_core = std::numeric_limits<std::size_t>::max();
+
+    // Core index of the worker running on this thread, no_core elsewhere
+    thread_local std::size_t tls_core = no_core;
+
+    // Set when the running frame was handed to the reactor or a ring. After
+    // that another core may already be resuming it, so the worker must not
+    // look at the frame (not even its context) once resume() returns.
+    thread_local bool tls_handed_off = false;
+
+    inline VThreadContext &context_of(std::coroutine_handle<> h) noexcept
+    {
+        return detail::promise_base::context_of(h);
+    }
+
+    // Tasks a busy worker runs between non-blocking reactor polls
+    constexpr std::size_t io_poll_interval = 32;
+
+    // Upper bound on how long an idle worker blocks in its reactor
+    constexpr int idle_poll_timeout_ms = 10;
+
+    // Most frames a thief migrates in one steal
+    constexpr std::size_t max_steal_batch = 64;
+}
+
 vthread_scheduler &vthread_scheduler::instance()
 {
     static vthread_scheduler inst;
@@ -27,30 +57,33 @@ void vthread_scheduler::start(std::size_t threads)
     ncores_ = threads ? threads : std::thread::hardware_concurrency();
     
     // Initialize core data structures
-    queues_.resize(ncores_);
-    arenas_.reserve(ncores_);
+    deques_.resize(ncores_);
+    inboxes_.resize(ncores_);
     core_loads_.resize(ncores_);
-    worker_conditions_.resize(ncores_);
-    worker_mutexes_.resize(ncores_);
-    worker_sleeping_.resize(ncores_, false);
+    event_loops_.resize(ncores_);
+    ring_event_fds_.assign(ncores_, -1);
+    worker_sleeping_.resize(ncores_);
+    timers_.resize(ncores_);
     
-    // Initialize per-core memory arenas
     for (std::size_t i = 0; i < ncores_; ++i) {
-        arenas_.emplace_back(std::make_unique<std::pmr::monotonic_buffer_resource>(1024 * 1024)); // 1 MiB per-core
+        deques_[i] = std::make_unique<deque_t>();
         core_loads_[i] = std::make_unique<std::atomic<uint32_t>>(0);
-        worker_conditions_[i] = std::make_unique<std::condition_variable>();
-        worker_mutexes_[i] = std::make_unique<std::mutex>();
+        event_loops_[i] = std::make_unique<event_loop>();
+        worker_sleeping_[i] = std::make_unique<std::atomic<bool>>(false);
+        timers_[i] = std::make_unique<detail::timer_wheel>();
     }
     
     // Initialize statistics
-    stats_.per_core_executed.resize(ncores_, 0);
+    core_stats_.resize(ncores_);
+    for (auto &st : core_stats_) {
+        st = std::make_unique<core_stats>();
+    }
     
-    // Start event loop and I/O context
-    event_loop_ = std::make_unique<event_loop>();
+    // Start the I/O context with one ring per core; workers attach their own
     io_context_ = std::shared_ptr<io_context>(&io_context::instance(), [](io_context*){});
+    io_context_->start(ncores_);
     
     running_ = true;
-    cleanup_running_ = true;
     
     // Start worker threads
     workers_.reserve(ncores_);
@@ -58,17 +91,7 @@ void vthread_scheduler::start(std::size_t threads)
         workers_.emplace_back([this, i] { worker(i); });
     }
     
-    // Start cleanup thread
-    cleanup_thread_ = std::thread([this] { 
-        while (cleanup_running_) {
-            cleanup_expired_io_operations();
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-    });
-    
-    last_balance_time_ = std::chrono::steady_clock::now();
-    
-    std::cerr << "[SwiftNet] Advanced scheduler online with " << ncores_ << " cores\n";
+    SWIFTNET_LOG_INFO("scheduler online with {} cores", ncores_);
 }
 
 void vthread_scheduler::stop()
@@ -78,7 +101,6 @@ void vthread_scheduler::stop()
         return;
         
     running_ = false;
-    cleanup_running_ = false;
     
     // Wake up all sleeping workers
     for (std::size_t i = 0; i < ncores_; ++i) {
@@ -92,41 +114,27 @@ void vthread_scheduler::stop()
         }
     }
     
-    // Join cleanup thread
-    if (cleanup_thread_.joinable()) {
-        cleanup_thread_.join();
-    }
-    
-    // Clean up remaining I/O operations
-    {
-        std::lock_guard<std::mutex> io_lock(io_operations_mutex_);
-        for (auto& [handle, op] : io_operations_) {
-            if (handle && !handle.done()) {
-                handle.destroy();
-            }
-        }
-        io_operations_.clear();
-    }
-    
-    // Clean up virtual thread contexts
-    {
-        std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-        vthread_contexts_.clear();
+    // Destroy frames that never got to run
+    for (std::size_t i = 0; i < ncores_; ++i) {
+        task_t h;
+        while (deques_[i]->pop(h)) h.destroy();
+        while (inboxes_[i].pop(h)) h.destroy();
     }
     
     // Clean up resources
     workers_.clear();
-    queues_.clear();
-    arenas_.clear();
+    deques_.clear();
+    inboxes_.clear();
     core_loads_.clear();
-    worker_conditions_.clear();
-    worker_mutexes_.clear();
+    event_loops_.clear();
+    ring_event_fds_.clear();
     worker_sleeping_.clear();
+    timers_.clear();
     
-    event_loop_.reset();
+    io_context_->stop();
     io_context_.reset();
     
-    std::cerr << "[SwiftNet] Advanced scheduler stopped\n";
+    SWIFTNET_LOG_INFO("scheduler stopped");
 }
 
 void vthread_scheduler::bind_core(std::size_t c)
@@ -146,62 +154,26 @@ void vthread_scheduler::bind_core(std::size_t c)
 void vthread_scheduler::worker(std::size_t core)
 {
     bind_core(core);
+    tls_core = core;
+    detail::frame_pool::bind_thread(core);
+    
+    // Enable this core's ring on its issuing thread and let CQEs wake the reactor
+    int ring_fd = io_context_->attach(core);
+    if (ring_fd != -1 && event_loops_[core]->add(ring_fd, READABLE)) {
+        ring_event_fds_[core] = ring_fd;
+    }
     
-    std::mt19937 rng{static_cast<uint32_t>(core * 7919 + 17)};
-    auto last_balance_check = std::chrono::steady_clock::now();
+    std::size_t since_io_poll = 0;
     
     while (running_) {
         bool found_work = false;
         
-        // Try to get work from local queue
-        vthread task;
-        if (queues_[core].pop(task)) {
+        // Own deque first (LIFO keeps the most recently woken frame hot),
+        // then whatever other threads handed this core
+        task_t h;
+        if (deques_[core]->pop(h) || (drain_inbox(core) && deques_[core]->pop(h))) {
             found_work = true;
-            
-            if (task.valid() && !task.is_done()) {
-                // Mount the virtual thread
-                mount_vthread(task.handle(), core);
-                
-                // Execute the virtual thread
-                auto suspend_reason = execute_vthread(task.handle());
-                
-                // Handle suspension reason
-                switch (suspend_reason) {
-                    case SuspendReason::NONE:
-                        // Continue execution
-                        if (!task.is_done()) {
-                            queues_[core].push(std::move(task));
-                        }
-                        break;
-                        
-                    case SuspendReason::IO_WAIT:
-                        // Virtual thread is suspended for I/O - don't reschedule
-                        break;
-                        
-                    case SuspendReason::YIELD:
-                        // Reschedule to a potentially different core
-                        schedule(std::move(task));
-                        break;
-                        
-                    case SuspendReason::COMPLETED:
-                        // Virtual thread completed - cleanup already handled by notify_completion
-                        // Just decrease the core load
-                        core_loads_[core]->fetch_sub(1, std::memory_order_relaxed);
-                        break;
-                        
-                    case SuspendReason::PREEMPTED:
-                        // Reschedule immediately
-                        queues_[core].push(std::move(task));
-                        break;
-                }
-                
-                // Update statistics
-                {
-                    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-                    stats_.per_core_executed[core]++;
-                    stats_.context_switches++;
-                }
-            }
+            run_task(vthread::from_handle(h), core);
         }
         
         // Try work stealing if no local work found
@@ -209,95 +181,197 @@ void vthread_scheduler::worker(std::size_t core)
             found_work = try_steal_work(core);
         }
         
-        // Periodic load balancing
-        auto now = std::chrono::steady_clock::now();
-        if (now - last_balance_check > std::chrono::milliseconds(50)) {
-            balance_load();
-            last_balance_check = now;
+        // A busy core still reaps readiness regularly so its sockets are not starved
+        if (found_work && ++since_io_poll >= io_poll_interval) {
+            // Also keep the inbox from starving behind a deque that never empties
+            drain_inbox(core);
+            poll_io(core, 0);
+            since_io_poll = 0;
         }
         
-        // Sleep if no work found
+        // Sleep in the reactor if no work found
         if (!found_work) {
             sleep_worker(core);
+            since_io_poll = 0;
         }
     }
     
-    std::cerr << "[SwiftNet] Worker " << core << " shutting down\n";
+    detail::frame_pool::unbind_thread();
+    tls_core = no_core;
+    SWIFTNET_LOG_DEBUG("worker {} shutting down", core);
 }
 
 bool vthread_scheduler::try_steal_work(std::size_t core)
 {
-    std::mt19937 rng{static_cast<uint32_t>(core * 7919 + 17)};
+    // Rob the core with the longest deque; sizes are racy but only steer the choice
+    std::size_t victim = core;
+    std::size_t victim_len = 0;
+    for (std::size_t i = 1; i < ncores_; ++i) {
+        std::size_t c = (core + i) % ncores_;
+        std::size_t len = deques_[c]->size();
+        if (len > victim_len) {
+            victim = c;
+            victim_len = len;
+        }
+    }
+    if (victim == core) return false;
     
-    // Try to steal from 4 random cores
-    for (int attempts = 0; attempts < 4; ++attempts) {
-        std::size_t victim = rng() % ncores_;
-        if (victim == core) continue;
-        
-        vthread task;
-        if (queues_[victim].pop(task)) {
-            if (task.valid() && !task.is_done()) {
-                // Successfully stole work
-                mount_vthread(task.handle(), core);
-                auto suspend_reason = execute_vthread(task.handle());
-                
-                // Handle stolen work
-                switch (suspend_reason) {
-                    case SuspendReason::NONE:
-                        if (!task.is_done()) {
-                            queues_[core].push(std::move(task));
-                        } else {
-                            // Thread completed during execution - cleanup handled by notify_completion
-                            core_loads_[core]->fetch_sub(1, std::memory_order_relaxed);
-                        }
-                        break;
-                    case SuspendReason::IO_WAIT:
-                        break;
-                    case SuspendReason::YIELD:
-                        schedule(std::move(task));
-                        break;
-                    case SuspendReason::COMPLETED:
-                        // Virtual thread completed - cleanup already handled by notify_completion
-                        core_loads_[core]->fetch_sub(1, std::memory_order_relaxed);
-                        break;
-                    case SuspendReason::PREEMPTED:
-                        queues_[core].push(std::move(task));
-                        break;
-                }
-                
-                // Update statistics
-                {
-                    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-                    stats_.work_stolen++;
-                    stats_.per_core_executed[core]++;
-                }
-                
-                return true;
+    core_stats &st = *core_stats_[core];
+    st.steal_attempts.fetch_add(1, std::memory_order_relaxed);
+    
+    // Take up to half of it: run the oldest frame now, keep the rest locally
+    std::size_t want = std::min((victim_len + 1) / 2, max_steal_batch);
+    task_t first;
+    if (!deques_[victim]->steal(first)) return false;
+    
+    std::size_t taken = 1;
+    task_t h;
+    while (taken < want && deques_[victim]->steal(h)) {
+        deques_[core]->push(h);
+        ++taken;
+    }
+    
+    core_loads_[victim]->fetch_sub(static_cast<uint32_t>(taken), std::memory_order_relaxed);
+    core_loads_[core]->fetch_add(static_cast<uint32_t>(taken), std::memory_order_relaxed);
+    
+    // Spread a large haul further if other cores are idle
+    if (taken > 1) {
+        wake_idle_sibling(core);
+    }
+    
+    st.steals.fetch_add(1, std::memory_order_relaxed);
+    st.stolen.fetch_add(taken, std::memory_order_relaxed);
+    
+    run_task(vthread::from_handle(first), core);
+    return true;
+}
+
+void vthread_scheduler::run_task(vthread task, std::size_t core)
+{
+    if (!task.valid() || task.is_done()) return;
+    
+    // Mount the virtual thread
+    mount_vthread(task.handle(), core);
+    auto mounted_at = context_of(task.handle()).last_resume;
+    
+    // Execute the virtual thread
+    auto suspend_reason = execute_vthread(task.handle());
+    
+    // Measured here rather than from the context: after IO_WAIT the frame is not ours
+    core_stats &st = *core_stats_[core];
+    st.executed.fetch_add(1, std::memory_order_relaxed);
+    st.context_switches.fetch_add(1, std::memory_order_relaxed);
+    st.mounted_ns.fetch_add(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mounted_at).count()),
+        std::memory_order_relaxed);
+    
+    if (suspend_reason != SuspendReason::IO_WAIT) {
+        unmount_vthread(task.handle(), core);
+    }
+    
+    // Handle suspension reason
+    switch (suspend_reason) {
+        case SuspendReason::NONE:
+        case SuspendReason::PREEMPTED:
+            // Requeue behind the work that is already waiting on this core
+            if (!task.is_done()) {
+                context_of(task.handle()).enqueued_at = std::chrono::steady_clock::now();
+                inboxes_[core].push(task.release());
             }
-        }
+            break;
+            
+        case SuspendReason::IO_WAIT:
+            // Parked on a reactor slot - the reactor hands the frame back via resume_from_io,
+            // which counts it against whichever core it is queued on then
+            (void)task.release();
+            core_loads_[core]->fetch_sub(1, std::memory_order_relaxed);
+            break;
+            
+        case SuspendReason::YIELD:
+            // Reschedule to a potentially different core, which takes over its load
+            core_loads_[core]->fetch_sub(1, std::memory_order_relaxed);
+            schedule(std::move(task));
+            break;
+            
+        case SuspendReason::COMPLETED:
+            // Virtual thread completed - cleanup already handled by notify_completion
+            // Just decrease the core load
+            core_loads_[core]->fetch_sub(1, std::memory_order_relaxed);
+            break;
     }
     
-    return false;
+    // Submit whatever SQEs the task queued before it unmounted
+    io_context_->flush(core);
+}
+
+void vthread_scheduler::enqueue(vthread t, std::size_t core)
+{
+    task_t h = t.release();
+    if (!h) return;
+    
+    // The frame is ours until it is published below
+    context_of(h).enqueued_at = std::chrono::steady_clock::now();
+    stats_for(core).scheduled.fetch_add(1, std::memory_order_relaxed);
+    
+    // Only the owning worker may push to its deque; everyone else uses the inbox
+    if (tls_core == core) {
+        deques_[core]->push(h);
+        
+        // This core already has something to run, so surplus is for thieves
+        if (deques_[core]->size() > 1) {
+            wake_idle_sibling(core);
+        }
+    } else {
+        inboxes_[core].push(h);
+        wake_worker(core);
+    }
+}
+
+std::size_t vthread_scheduler::drain_inbox(std::size_t core)
+{
+    std::size_t n = 0;
+    task_t h;
+    while (inboxes_[core].pop(h)) {
+        deques_[core]->push(h);
+        ++n;
+    }
+    return n;
 }
 
 void vthread_scheduler::wake_worker(std::size_t core)
 {
-    std::lock_guard<std::mutex> lock(*worker_mutexes_[core]);
-    if (worker_sleeping_[core]) {
-        worker_sleeping_[core] = false;
-        worker_conditions_[core]->notify_one();
+    // Only pay for the eventfd write when the worker is actually blocked
+    if (worker_sleeping_[core]->exchange(false)) {
+        event_loops_[core]->notify();
+    }
+}
+
+void vthread_scheduler::wake_idle_sibling(std::size_t core)
+{
+    for (std::size_t i = 1; i < ncores_; ++i) {
+        std::size_t c = (core + i) % ncores_;
+        if (worker_sleeping_[c]->load(std::memory_order_relaxed)) {
+            wake_worker(c);
+            return;
+        }
     }
 }
 
 void vthread_scheduler::sleep_worker(std::size_t core)
 {
-    std::unique_lock<std::mutex> lock(*worker_mutexes_[core]);
-    worker_sleeping_[core] = true;
+    worker_sleeping_[core]->store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    // Re-check after publishing the flag so a concurrent push is not missed
+    if (!running_ || !deques_[core]->empty() || !inboxes_[core].empty()) {
+        worker_sleeping_[core]->store(false);
+        return;
+    }
     
-    // Wait for work or shutdown
-    worker_conditions_[core]->wait_for(lock, std::chrono::milliseconds(10), [this, core] {
-        return !running_ || !worker_sleeping_[core];
-    });
+    // Block in the reactor: I/O readiness and wake_worker() both end the
+    // wait, and it is cut short when the next timer falls due
+    poll_io(core, timers_[core]->next_timeout_ms(idle_poll_timeout_ms));
+    worker_sleeping_[core]->store(false);
 }
 
 void vthread_scheduler::schedule(vthread t)
@@ -305,17 +379,8 @@ void vthread_scheduler::schedule(vthread t)
     if (!running_) return;
     
     auto core = select_best_core();
-    queues_[core].push(std::move(t));
     core_loads_[core]->fetch_add(1, std::memory_order_relaxed);
-    
-    // Wake up the worker if it's sleeping
-    wake_worker(core);
-    
-    // Update statistics
-    {
-        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-        stats_.total_scheduled++;
-    }
+    enqueue(std::move(t), core);
 }
 
 void vthread_scheduler::schedule_with_affinity(vthread t, std::size_t preferred_core)
@@ -323,141 +388,214 @@ void vthread_scheduler::schedule_with_affinity(vthread t, std::size_t preferred_
     if (!running_) return;
     
     std::size_t core = std::min(preferred_core, ncores_ - 1);
-    queues_[core].push(std::move(t));
     core_loads_[core]->fetch_add(1, std::memory_order_relaxed);
-    
-    wake_worker(core);
-    
-    {
-        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-        stats_.total_scheduled++;
-    }
+    enqueue(std::move(t), core);
 }
 
 void vthread_scheduler::yield_current(std::coroutine_handle<> h)
 {
     if (!h || h.done()) return;
-    
-    std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-    auto it = vthread_contexts_.find(h);
-    if (it != vthread_contexts_.end()) {
-        it->second.suspend_reason = SuspendReason::YIELD;
-    }
+    context_of(h).suspend_reason = SuspendReason::YIELD;
 }
 
-void vthread_scheduler::suspend_for_io(std::coroutine_handle<> h, int fd, uint32_t events)
+bool vthread_scheduler::suspend_for_io(std::coroutine_handle<> h, io_awaitable *op, int fd, uint32_t events)
 {
-    if (!h || h.done()) return;
+    if (!running_ || !h || h.done()) return false;
     
-    // Add to I/O operations tracking
-    {
-        std::lock_guard<std::mutex> io_lock(io_operations_mutex_);
-        io_operations_.emplace(h, IOOperation{fd, events, h});
+    detail::fd_state *st = fds_.get(fd);
+    if (!st) return false;
+    
+    // Register edge-triggered for both directions once per descriptor, on
+    // the reactor of the core that first waits on it
+    if (st->owner.load(std::memory_order_acquire) < 0 &&
+        !register_fd(*st, fd, tls_core != no_core ? tls_core : select_best_core())) {
+        return false;
     }
     
-    // Update virtual thread context
-    {
-        std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-        auto it = vthread_contexts_.find(h);
-        if (it != vthread_contexts_.end()) {
-            it->second.suspend_reason = SuspendReason::IO_WAIT;
+    // The context must be final before the frame is published on the slot
+    VThreadContext &ctx = context_of(h);
+    ctx.suspend_reason = SuspendReason::IO_WAIT;
+    ctx.is_mounted = false;
+    
+    // Park on the direction's slot unless an edge was latched meanwhile
+    auto &slot = (events & POLLOUT) ? st->writer : st->reader;
+    
+    // A deadline is armed first: once published, the frame may be resumed
+    // (and freed) by another core at any moment
+    bool timed = op->arm_deadline(slot);
+    
+    std::uintptr_t expected = 0;
+    if (!slot.compare_exchange_strong(expected, reinterpret_cast<std::uintptr_t>(op), std::memory_order_acq_rel)) {
+        if (timed) {
+            op->disarm_deadline();
         }
+        
+        // Consume the latched readiness and let the caller retry its syscall
+        slot.store(0, std::memory_order_release);
+        ctx.suspend_reason = SuspendReason::NONE;
+        ctx.is_mounted = true;
+        return false;
     }
+    tls_handed_off = true;
     
-    // Register with event loop for I/O completion
-    if (event_loop_) {
-        event_loop_->add(fd, events);
-    }
+    stats_for(tls_core).io_suspended.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void vthread_scheduler::suspend_for_completion(std::coroutine_handle<> h)
+{
+    if (!h || h.done()) return;
     
-    // Update statistics
-    {
-        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-        stats_.total_io_suspended++;
-    }
+    // Called before the SQE is submitted, so nothing can complete it yet
+    VThreadContext &ctx = context_of(h);
+    ctx.suspend_reason = SuspendReason::IO_WAIT;
+    ctx.is_mounted = false;
+    tls_handed_off = true;
+    
+    stats_for(tls_core).io_suspended.fetch_add(1, std::memory_order_relaxed);
 }
 
 void vthread_scheduler::resume_from_io(std::coroutine_handle<> h, int result)
 {
-    std::cout << "[DEBUG] resume_from_io called! handle=" << (void*)h.address() << " result=" << result << std::endl;
-    
-    if (!h) {
-        std::cout << "[DEBUG] resume_from_io: handle is NULL, returning" << std::endl;
-        return;
-    }
+    (void)result;
+    if (!h || h.done()) return;
     
-    if (h.done()) {
-        std::cout << "[DEBUG] resume_from_io: handle is DONE (coroutine completed), returning" << std::endl;
-        return;
-    }
+    // The reactor owns the frame now, so updating its context is race-free
+    context_of(h).suspend_reason = SuspendReason::NONE;
     
-    std::cout << "[DEBUG] resume_from_io: handle is valid and not done, proceeding..." << std::endl;
+    // Readiness is reaped by the owning core's worker, so the coroutine is
+    // queued right back onto that core
+    std::size_t core = tls_core != no_core ? tls_core : select_best_core();
+    stats_for(core).resumed.fetch_add(1, std::memory_order_relaxed);
     
-    std::cout << "[DEBUG] resume_from_io: removing from I/O operations..." << std::endl;
+    // h may be a child deep in an await chain; the chain is queued by its root,
+    // which remembers h as the frame to resume
+    schedule_with_affinity(vthread::from_handle(detail::promise_base::root_of(h)), core);
+}
+
+bool vthread_scheduler::suspend_for_timer(std::coroutine_handle<> h, detail::timer_node *t, std::chrono::steady_clock::time_point deadline)
+{
+    // Off a worker there is nobody to hand the frame back to
+    if (!running_ || tls_core == no_core || !h || h.done()) return false;
+    
+    VThreadContext &ctx = context_of(h);
+    ctx.suspend_reason = SuspendReason::IO_WAIT;
+    ctx.is_mounted = false;
+    tls_handed_off = true;
+    
+    // Only this worker advances its wheel, so the timer cannot fire before
+    // the frame has finished suspending
+    timers_[tls_core]->arm(t, detail::timer_wheel::to_tick(deadline));
+    return true;
+}
+
+bool vthread_scheduler::arm_timer(detail::timer_node *t, std::chrono::steady_clock::time_point deadline)
+{
+    if (!running_) return false;
     
-    // Remove from I/O operations tracking
-    {
-        std::lock_guard<std::mutex> io_lock(io_operations_mutex_);
-        auto it = io_operations_.find(h);
-        if (it != io_operations_.end()) {
-            if (event_loop_) {
-                event_loop_->del(it->second.fd);
-            }
-            io_operations_.erase(it);
-            std::cout << "[DEBUG] resume_from_io: removed from I/O operations" << std::endl;
-        } else {
-            std::cout << "[DEBUG] resume_from_io: handle not found in I/O operations!" << std::endl;
-        }
+    // From outside a worker the timer may fire up to one idle poll late
+    std::size_t core = tls_core != no_core ? tls_core : select_best_core();
+    timers_[core]->arm(t, detail::timer_wheel::to_tick(deadline));
+    return true;
+}
+
+void vthread_scheduler::cancel_timer(detail::timer_node *t)
+{
+    if (t->wheel) {
+        t->wheel->cancel(t);
     }
+}
+
+bool vthread_scheduler::bind_fd(int fd, std::size_t core)
+{
+    if (!running_ || core >= ncores_) return false;
     
-    std::cout << "[DEBUG] resume_from_io: updating context..." << std::endl;
+    detail::fd_state *st = fds_.get(fd);
+    if (!st) return false;
+    int owner = st->owner.load(std::memory_order_acquire);
+    if (owner >= 0) return static_cast<std::size_t>(owner) == core;
+    return register_fd(*st, fd, core);
+}
+
+bool vthread_scheduler::register_fd(detail::fd_state &st, int fd, std::size_t core)
+{
+    int expected = -1;
+    if (!st.owner.compare_exchange_strong(expected, static_cast<int>(core), std::memory_order_acq_rel)) {
+        return true; // someone else registered it first
+    }
+    if (!event_loops_[core]->add(fd, READABLE | WRITABLE)) {
+        st.owner.store(-1, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void vthread_scheduler::release_fd(int fd)
+{
+    detail::fd_state *st = fds_.find(fd);
+    if (!st) return;
     
-    // Update virtual thread context to show it's no longer waiting for I/O
-    {
-        std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-        auto it = vthread_contexts_.find(h);
-        if (it != vthread_contexts_.end()) {
-            it->second.suspend_reason = SuspendReason::NONE;
-            std::cout << "[DEBUG] resume_from_io: updated context suspend reason" << std::endl;
-        } else {
-            std::cout << "[DEBUG] resume_from_io: context not found!" << std::endl;
-        }
+    int owner = st->owner.exchange(-1, std::memory_order_acq_rel);
+    if (owner >= 0 && static_cast<std::size_t>(owner) < event_loops_.size()) {
+        event_loops_[owner]->del(fd);
     }
+    st->reader.store(0, std::memory_order_release);
+    st->writer.store(0, std::memory_order_release);
+}
+
+std::size_t vthread_scheduler::current_core() const noexcept
+{
+    return tls_core;
+}
+
+void vthread_scheduler::poll_io(std::size_t core, int timeout_ms)
+{
+    // Completions are cheap to check (no syscall), so drain them on every poll
+    io_context_->reap(core);
     
-    std::cout << "[DEBUG] resume_from_io: scheduling coroutine through scheduler..." << std::endl;
+    io_event events[64];
+    int n = event_loops_[core]->wait(events, 64, timeout_ms);
     
-    // CRITICAL FIX: Instead of calling h.resume() directly from background thread,
-    // schedule the coroutine through the scheduler to avoid deadlocks
-    if (!h.done()) {
-        try {
-            vthread resumed_vthread = vthread::from_handle(h);
-            schedule(std::move(resumed_vthread));
-            std::cout << "[DEBUG] resume_from_io: coroutine scheduled successfully" << std::endl;
-        } catch (const std::exception& e) {
-            std::cout << "[DEBUG] resume_from_io: exception during scheduling: " << e.what() << std::endl;
+    for (int i = 0; i < n; ++i) {
+        if (events[i].fd == ring_event_fds_[core]) {
+            io_context_->reap(core);
+            continue;
+        }
+        
+        detail::fd_state *st = fds_.find(events[i].fd);
+        if (!st) continue;
+        
+        uint32_t mask = events[i].mask;
+        if (mask & (READABLE | CLOSED)) {
+            wake_io_waiter(st->reader, (mask & CLOSED) ? POLLIN | POLLHUP : POLLIN);
+        }
+        if (mask & (WRITABLE | CLOSED)) {
+            wake_io_waiter(st->writer, (mask & CLOSED) ? POLLOUT | POLLHUP : POLLOUT);
         }
-    } else {
-        std::cout << "[DEBUG] resume_from_io: handle became done during processing!" << std::endl;
     }
     
-    // Update statistics
-    {
-        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-        stats_.total_resumed++;
-        std::cout << "[DEBUG] resume_from_io: statistics updated, total_resumed=" << stats_.total_resumed << std::endl;
-    }
+    // Deadlines are checked at the same cadence as readiness
+    timers_[core]->advance(detail::timer_wheel::now_tick());
 }
 
-void vthread_scheduler::cancel_io_operation(std::coroutine_handle<> h)
+void vthread_scheduler::wake_io_waiter(std::atomic<std::uintptr_t> &slot, int result)
 {
-    if (!h) return;
-    
-    std::lock_guard<std::mutex> io_lock(io_operations_mutex_);
-    auto it = io_operations_.find(h);
-    if (it != io_operations_.end()) {
-        if (event_loop_) {
-            event_loop_->del(it->second.fd);
+    std::uintptr_t cur = slot.load(std::memory_order_acquire);
+    while (true) {
+        if (cur == detail::fd_state::ready) {
+            return; // already latched
+        }
+        if (cur == 0) {
+            // Nobody waiting - latch the edge for the next await
+            if (slot.compare_exchange_weak(cur, detail::fd_state::ready, std::memory_order_acq_rel)) {
+                return;
+            }
+            continue;
+        }
+        if (slot.compare_exchange_weak(cur, 0, std::memory_order_acq_rel)) {
+            reinterpret_cast<io_awaitable *>(cur)->complete(result);
+            return;
         }
-        io_operations_.erase(it);
     }
 }
 
@@ -465,46 +603,29 @@ void vthread_scheduler::mount_vthread(std::coroutine_handle<> h, std::size_t cor
 {
     if (!h) return;
     
-    std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-    auto it = vthread_contexts_.find(h);
-    if (it == vthread_contexts_.end()) {
-        // Create new context
-        vthread_contexts_.emplace(h, VThreadContext{h});
-        it = vthread_contexts_.find(h);
-    }
+    VThreadContext &ctx = context_of(h);
+    ctx.is_mounted = true;
+    ctx.core_affinity = static_cast<uint32_t>(core);
+    ctx.last_resume = std::chrono::steady_clock::now();
+    ctx.suspend_reason = SuspendReason::NONE;
     
-    it->second.is_mounted = true;
-    it->second.core_affinity = core;
-    it->second.last_resume = std::chrono::steady_clock::now();
-    it->second.suspend_reason = SuspendReason::NONE;
+    if (ctx.enqueued_at != std::chrono::steady_clock::time_point{} && core < core_stats_.size()) {
+        auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(ctx.last_resume - ctx.enqueued_at);
+        core_stats_[core]->queue_wait_ns.fetch_add(static_cast<uint64_t>(wait.count()), std::memory_order_relaxed);
+    }
 }
 
 void vthread_scheduler::unmount_vthread(std::coroutine_handle<> h, std::size_t core)
 {
+    (void)core;
     if (!h) return;
     
-    std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-    auto it = vthread_contexts_.find(h);
-    if (it != vthread_contexts_.end()) {
-        it->second.is_mounted = false;
-        
-        // Update CPU time
-        auto now = std::chrono::steady_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-            now - it->second.last_resume
-        );
-        it->second.cpu_time_us += duration.count();
-        
-        // Remove context if completed (but this should already be handled by notify_completion)
-        if (it->second.suspend_reason == SuspendReason::COMPLETED) {
-            vthread_contexts_.erase(it);
-        }
-    }
+    VThreadContext &ctx = context_of(h);
+    ctx.is_mounted = false;
     
-    // Decrease core load
-    if (core < core_loads_.size()) {
-    core_loads_[core]->fetch_sub(1, std::memory_order_relaxed);
-    }
+    // Update CPU time
+    auto now = std::chrono::steady_clock::now();
+    ctx.cpu_time_us += std::chrono::duration_cast<std::chrono::microseconds>(now - ctx.last_resume).count();
 }
 
 SuspendReason vthread_scheduler::execute_vthread(std::coroutine_handle<> h)
@@ -514,32 +635,28 @@ SuspendReason vthread_scheduler::execute_vthread(std::coroutine_handle<> h)
     }
     
     // Check if we should preempt based on execution time
-    {
-        std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-        auto it = vthread_contexts_.find(h);
-        if (it != vthread_contexts_.end() && should_preempt_vthread(it->second)) {
-            return SuspendReason::PREEMPTED;
-        }
+    if (should_preempt_vthread(context_of(h))) {
+        return SuspendReason::PREEMPTED;
     }
     
     // Execute the coroutine
+    tls_handed_off = false;
     try {
-        h.resume();
+        detail::promise_base::resume_point(h).resume();
+        
+        // Handed to the reactor: the frame may already be running elsewhere
+        if (tls_handed_off) {
+            return SuspendReason::IO_WAIT;
+        }
         
         if (h.done()) {
             return SuspendReason::COMPLETED;
         }
         
         // Check suspension reason
-        std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-        auto it = vthread_contexts_.find(h);
-        if (it != vthread_contexts_.end()) {
-            return it->second.suspend_reason;
-        }
-        
-        return SuspendReason::NONE;
+        return context_of(h).suspend_reason;
     } catch (const std::exception& e) {
-        std::cerr << "[SwiftNet] Exception in vthread: " << e.what() << std::endl;
+        SWIFTNET_LOG_ERROR("exception in vthread: {}", e.what());
         return SuspendReason::COMPLETED;
     }
 }
@@ -560,44 +677,6 @@ std::size_t vthread_scheduler::select_best_core() const
     return best_core;
 }
 
-void vthread_scheduler::balance_load()
-{
-    // Simple load balancing - move work from overloaded cores to underloaded ones
-    auto now = std::chrono::steady_clock::now();
-    if (now - last_balance_time_ < std::chrono::milliseconds(100)) {
-        return;
-    }
-    
-    last_balance_time_ = now;
-    
-    // Find the most and least loaded cores
-    std::size_t max_core = 0, min_core = 0;
-    uint32_t max_load = 0, min_load = UINT32_MAX;
-    
-    for (std::size_t i = 0; i < ncores_; ++i) {
-        uint32_t load = core_loads_[i]->load(std::memory_order_relaxed);
-        if (load > max_load) {
-            max_load = load;
-            max_core = i;
-        }
-        if (load < min_load) {
-            min_load = load;
-            min_core = i;
-        }
-    }
-    
-    // If difference is significant, try to steal work
-    if (max_load > min_load + 2) {
-        vthread task;
-        if (queues_[max_core].pop(task)) {
-            queues_[min_core].push(std::move(task));
-            core_loads_[max_core]->fetch_sub(1, std::memory_order_relaxed);
-            core_loads_[min_core]->fetch_add(1, std::memory_order_relaxed);
-            wake_worker(min_core);
-        }
-    }
-}
-
 bool vthread_scheduler::should_preempt_vthread(const VThreadContext& ctx) const
 {
     // Preempt if vthread has been running for more than 10ms
@@ -608,40 +687,52 @@ bool vthread_scheduler::should_preempt_vthread(const VThreadContext& ctx) const
     return duration.count() > 10;
 }
 
-void vthread_scheduler::cleanup_expired_io_operations()
+auto vthread_scheduler::get_stats() const -> Stats
 {
-    auto now = std::chrono::steady_clock::now();
-    std::vector<std::coroutine_handle<>> expired;
-    
-    {
-        std::lock_guard<std::mutex> io_lock(io_operations_mutex_);
-        for (auto it = io_operations_.begin(); it != io_operations_.end(); ) {
-            auto duration = std::chrono::duration_cast<std::chrono::seconds>(
-                now - it->second.start_time
-            );
-            
-            // Clean up operations that have been waiting for more than 30 seconds
-            if (duration.count() > 30) {
-                expired.push_back(it->first);
-                it = io_operations_.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
-    
-    // Clean up expired operations
-    for (auto h : expired) {
-        if (h && !h.done()) {
-            h.destroy();
-        }
-    }
+    Stats stats;
+    stats.per_core_executed.reserve(core_stats_.size());
+    stats.per_core.reserve(core_stats_.size());
+    
+    uint64_t steals = 0, executed = 0, queue_wait_ns = 0, mounted_ns = 0;
+    for (std::size_t i = 0; i < core_stats_.size(); ++i) {
+        const core_stats &st = *core_stats_[i];
+        Stats::CoreStats core;
+        core.executed = st.executed.load(std::memory_order_relaxed);
+        core.io_suspended = st.io_suspended.load(std::memory_order_relaxed);
+        core.steal_attempts = st.steal_attempts.load(std::memory_order_relaxed);
+        core.steals = st.steals.load(std::memory_order_relaxed);
+        core.stolen = st.stolen.load(std::memory_order_relaxed);
+        // Racy read of another core's deque, fine for a gauge
+        core.run_queue = i < deques_.size() && deques_[i] ? deques_[i]->size() : 0;
+        
+        stats.total_scheduled += st.scheduled.load(std::memory_order_relaxed);
+        stats.total_io_suspended += core.io_suspended;
+        stats.total_resumed += st.resumed.load(std::memory_order_relaxed);
+        stats.work_stolen += core.stolen;
+        stats.context_switches += st.context_switches.load(std::memory_order_relaxed);
+        stats.steal_attempts += core.steal_attempts;
+        stats.per_core_executed.push_back(core.executed);
+        stats.per_core.push_back(core);
+        steals += core.steals;
+        executed += core.executed;
+        queue_wait_ns += st.queue_wait_ns.load(std::memory_order_relaxed);
+        mounted_ns += st.mounted_ns.load(std::memory_order_relaxed);
+    }
+    
+    if (stats.steal_attempts) {
+        stats.steal_success_rate = static_cast<double>(steals) / static_cast<double>(stats.steal_attempts);
+    }
+    if (executed) {
+        stats.avg_run_queue_wait_ns = queue_wait_ns / executed;
+        stats.avg_mounted_ns = mounted_ns / executed;
+    }
+    return stats;
 }
 
-auto vthread_scheduler::get_stats() const -> Stats
+auto vthread_scheduler::stats_for(std::size_t core) noexcept -> core_stats &
 {
-    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-    return stats_;
+    // Calls from outside a worker are charged to core 0
+    return *core_stats_[core < core_stats_.size() ? core : 0];
 }
 
 // Legacy interface implementations (for backward compatibility)
@@ -669,27 +760,12 @@ void vthread_scheduler::notify_completion(std::coroutine_handle<> h) noexcept
 {
     if (!h) return;
     
-    try {
-        {
-        std::lock_guard<std::mutex> ctx_lock(contexts_mutex_);
-        auto it = vthread_contexts_.find(h);
-        if (it != vthread_contexts_.end()) {
-            it->second.suspend_reason = SuspendReason::COMPLETED;
-                // Clean up the context immediately for completed threads
-                vthread_contexts_.erase(it);
-            }
-        }
-        
-        // DON'T destroy here - let the vthread destructor handle it
-        // This prevents double free errors
-    } catch (...) {
-        // Ignore exceptions in noexcept function
-    }
+    // The frame stays alive until its owning vthread is destroyed
+    context_of(h).suspend_reason = SuspendReason::COMPLETED;
 }
 
 std::pmr::memory_resource *vthread_scheduler::local_resource(std::size_t core)
 {
-    if (core >= arenas_.size())
-        return std::pmr::get_default_resource();
-    return arenas_[core].get();
+    // Arenas belong to the frame pool so they outlive the frames carved from them
+    return detail::frame_pool::arena(core);
 }
@@ -0,0 +1,150 @@
+// Renders binary access logs written by SwiftNet::access_log() as text
+// or as JSON, one request per line.
+//
+//   swiftnet_access_log [--json] FILE...
+//
+// Files are read in the order given, so pass rotated ones oldest first
+// (access.log.2 access.log.1 access.log).
+
+#include "http/access_log.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace swiftnet::http;
+
+namespace
+{
+    // ISO 8601 in UTC with microseconds
+    std::string format_time(std::uint64_t ns)
+    {
+        std::time_t secs = static_cast<std::time_t>(ns / 1000000000);
+        std::tm tm{};
+        gmtime_r(&secs, &tm);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &tm);
+        char out[48];
+        std::snprintf(out, sizeof(out), "%s.%06uZ", stamp, static_cast<unsigned>(ns / 1000 % 1000000));
+        return out;
+    }
+
+    std::string json_string(std::string_view s)
+    {
+        std::string out = "\"";
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char esc[8];
+                std::snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned>(c));
+                out += esc;
+            }
+            else
+            {
+                out += c;
+            }
+        }
+        return out + '"';
+    }
+
+    void print(const access_record &r, const std::vector<std::string> &routes, bool json)
+    {
+        std::string_view route = r.route < routes.size() ? std::string_view(routes[r.route]) : std::string_view("-");
+        std::string_view method = method_name(static_cast<access_method>(r.method));
+        bool cached = r.flags & access_cached;
+
+        if (json)
+        {
+            std::printf("{\"time\":\"%s\",\"method\":\"%.*s\",\"route\":%s,\"status\":%u,\"bytes\":%llu,"
+                        "\"latency_ns\":%llu,\"core\":%d,\"cached\":%s}\n",
+                        format_time(r.time_ns).c_str(), static_cast<int>(method.size()), method.data(),
+                        r.route < routes.size() ? json_string(route).c_str() : "null",
+                        static_cast<unsigned>(r.status), static_cast<unsigned long long>(r.bytes),
+                        static_cast<unsigned long long>(r.latency_ns), r.core == no_core ? -1 : r.core,
+                        cached ? "true" : "false");
+        }
+        else
+        {
+            std::printf("%s core=%s %.*s %.*s %u %lluB %.3fms%s\n", format_time(r.time_ns).c_str(),
+                        r.core == no_core ? "-" : std::to_string(r.core).c_str(), static_cast<int>(method.size()),
+                        method.data(), static_cast<int>(route.size()), route.data(), static_cast<unsigned>(r.status),
+                        static_cast<unsigned long long>(r.bytes), r.latency_ns / 1e6, cached ? " cached" : "");
+        }
+    }
+
+    bool dump(const char *path, bool json)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            std::fprintf(stderr, "%s: cannot open\n", path);
+            return false;
+        }
+
+        access_log_header h{};
+        if (!in.read(reinterpret_cast<char *>(&h), sizeof(h)) ||
+            std::memcmp(h.magic, access_log_magic, sizeof(h.magic)) != 0)
+        {
+            std::fprintf(stderr, "%s: not a SwiftNet access log\n", path);
+            return false;
+        }
+        if (h.version != access_log_version || h.record_size != sizeof(access_record))
+        {
+            std::fprintf(stderr, "%s: unsupported version %u (record size %u)\n", path, h.version, h.record_size);
+            return false;
+        }
+
+        std::vector<std::string> routes(h.routes);
+        for (auto &route : routes)
+        {
+            std::uint16_t length = 0;
+            if (!in.read(reinterpret_cast<char *>(&length), sizeof(length)))
+                break;
+            route.resize(length);
+            in.read(route.data(), length);
+        }
+        if (!in)
+        {
+            std::fprintf(stderr, "%s: truncated route table\n", path);
+            return false;
+        }
+
+        access_record r;
+        while (in.read(reinterpret_cast<char *>(&r), sizeof(r)))
+            print(r, routes, json);
+        // A partial record at the end is one still being written
+        return true;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool json = false;
+    std::vector<const char *> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+            json = true;
+        else
+            files.push_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        std::fprintf(stderr, "usage: %s [--json] FILE...\n", argv[0]);
+        return 2;
+    }
+
+    bool ok = true;
+    for (const char *path : files)
+        ok = dump(path, json) && ok;
+    return ok ? 0 : 1;
+}